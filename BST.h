@@ -1,30 +1,133 @@
 #ifndef BST_H
 #define BST_H
 
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// ================== Tree Statistics ==================
+// Snapshot of the shape of a tree, used to detect skew before it turns into
+// slow lookups. Depth is counted in edges (the root has depth 0).
+struct TreeStats {
+    std::size_t nodes = 0;              // number of nodes in the tree
+    int height = 0;                     // number of levels (0 for an empty tree)
+    int maxDepth = -1;                  // depth of the deepest node (-1 if empty)
+    double avgDepth = 0.0;              // mean node depth (average successful search path - 1)
+    std::vector<std::size_t> levelFill; // levelFill[d] = number of nodes at depth d (ideal is 2^d)
+};
+
+// ================== Range Callbacks ==================
+// Every index's rangeApply calls fn(key, value) through this: fn may return
+// void, or bool to stop the walk early by returning false (so a caller can
+// take a bounded batch and resume after the last key it saw).
+template <typename Fn, typename K, typename V>
+inline bool visitInRange(Fn &fn, const K &key, V &val) {
+    if constexpr (std::is_same_v<std::invoke_result_t<Fn &, const K &, V &>, bool>) {
+        return fn(key, val);
+    } else {
+        fn(key, val);
+        return true;
+    }
+}
+
+// ================== Subtree Summaries ==================
+// A Summary policy is a monoid over (key, value) pairs that BST keeps for
+// every subtree, so range aggregates can be answered from O(log n) nodes:
+//   value_type                  - the aggregate type
+//   identity()                  - aggregate of an empty range
+//   lift(key, value)            - aggregate of a single node
+//   combine(a, b)               - aggregate of two adjacent ranges (a before b)
+// All three are static. NoSummary is the default and costs nothing.
+struct NoSummary {
+    struct value_type {};
+    static value_type identity() { return {}; }
+    template <typename K, typename V>
+    static value_type lift(const K &, const V &) { return {}; }
+    static value_type combine(const value_type &, const value_type &) { return {}; }
+};
+
 // ================== Recursive BST ==================
 // Generic Binary Search Tree (BST) template
 // K - key type, must support comparison operators (<, ==)
 // V - value type (data stored in each node)
+// Summary - per-subtree aggregate policy (see NoSummary above)
+//
+// The tree is unbalanced but self-repairing (scapegoat rebuilding): when an
+// insert lands deeper than log_{1/alpha}(n) = c*log2(n), the lowest
+// alpha-unbalanced ancestor on the insert path (the first one met while
+// unwinding; a too-deep node always has one) is rebuilt into a perfectly
+// balanced subtree. Erases rebuild the whole tree once n drops below
+// alpha * (largest n since the last full rebuild). This gives amortized
+// O(log n) updates and worst-case O(log n) lookups without rotations or
+// balance flags. alpha = 0.75 (c ~ 2.41) by default; setBalanceFactor(1.0)
+// turns it off.
+//
+// Every node records the size of its subtree (order-statistic tree), which
+// makes rank/select/countRange O(log n) and gives the scapegoat check its
+// subtree weights for free. Nodes also cache the Summary, height and depth
+// sum of their subtree, refreshed on the same paths as the sizes.
+//
+// Read-only queries have const overloads taking an `int &cmp` counter that
+// the caller owns, so concurrent readers (under a shared lock) never write
+// to the tree; the overloads without it charge the shared `comparisons`.
 
-template <typename K, typename V>
+template <typename K, typename V, typename Summary = NoSummary>
 class BST {
+public:
+    using summary_type = typename Summary::value_type;
+
+private:
     // ----- Internal Node structure -----
     struct Node {
         K key;       // key used for ordering
         V val;       // associated value (payload)
         Node *left;  // pointer to left child (keys smaller than this node)
         Node *right; // pointer to right child (keys larger than this node)
+        std::size_t size; // number of nodes in this subtree (including itself)
+        int height;       // number of levels in this subtree
+        std::size_t depthSum; // sum of the node depths below this node (this node at depth 0)
+        summary_type agg; // Summary of this subtree
 
         // Constructor initializes node with given key-value pair
         Node(const K &k, const V &v)
-            : key(k), val(v), left(nullptr), right(nullptr) {}
+            : key(k), val(v), left(nullptr), right(nullptr), size(1), height(1), depthSum(0),
+              agg(Summary::lift(k, v)) {}
     };
 
     Node *root = nullptr;  // root pointer for the BST
+    std::size_t count = 0; // number of nodes, kept up to date by insert/erase
+    std::size_t maxCount = 0;   // largest count since the last full rebuild
+    double alpha = 0.75;        // scapegoat weight-balance factor, 1.0 disables rebuilding
+    std::size_t rebuildCount = 0; // number of subtree rebuilds performed
 
 public:
+    static constexpr bool selfAdjusting = false; // lookups never modify the tree
+    static constexpr bool concurrent = false;    // callers must serialize writers
+    static constexpr bool persistent = false;    // updates modify nodes in place
+
     int comparisons = 0;   // counts number of comparisons made (for performance analysis)
 
+    BST() = default;
+
+    // ----- Ownership -----
+    // Nodes are owned by the tree: copying is disabled, moving transfers them
+    BST(const BST &) = delete;
+    BST &operator=(const BST &) = delete;
+    BST(BST &&other) noexcept { swapWith(other); }
+    BST &operator=(BST &&other) noexcept {
+        if (this != &other) {
+            clear(root);
+            root = nullptr;
+            count = maxCount = 0;
+            swapWith(other);
+        }
+        return *this;
+    }
+
     // ----- Destructor -----
     // Ensures all dynamically allocated nodes are freed
     ~BST() { clear(root); }
@@ -33,36 +136,267 @@ public:
     // Inserts (key, value) into the BST
     // Returns true if inserted successfully, false if key already exists
     bool insert(const K &k, const V &v) {
-        return insertRec(root, k, v);
+        InsertState st;
+        insertRec(root, k, v, 0, st);
+        if (st.inserted && ++count > maxCount) maxCount = count;
+        return st.inserted;
+    }
+
+    // ----- Public wrapper: Bulk Insert -----
+    // Inserts `items`, which must be sorted by key; of equal keys only the
+    // first is inserted, as with repeated insert(). insertedOut[i] tells
+    // whether items[i] went in; returns the number inserted.
+    // A batch that is small next to the tree is inserted key by key
+    // (O(k log n)). A larger one is merged with the in-order node sequence
+    // and the whole tree is relinked perfectly balanced, O(n + k).
+    std::size_t insertSorted(const std::vector<std::pair<K, V>> &items, std::vector<char> &insertedOut) {
+        std::size_t k = items.size(), added = 0;
+        insertedOut.assign(k, 0);
+        if (k * std::log2((double)count + 2) < count) {
+            for (std::size_t i = 0; i < k; ++i) {
+                if (insert(items[i].first, items[i].second)) {
+                    insertedOut[i] = 1;
+                    ++added;
+                }
+            }
+            return added;
+        }
+
+        std::vector<Node *> old, merged;
+        old.reserve(count);
+        flatten(root, old);
+        merged.reserve(count + k);
+        std::size_t o = 0;
+        for (std::size_t i = 0; i < k; ++i) {
+            const K &key = items[i].first;
+            if (i > 0 && !(items[i - 1].first < key)) continue;   // repeated key in the batch
+            while (o < old.size() && (++comparisons, old[o]->key < key)) merged.push_back(old[o++]);
+            if (o < old.size() && (++comparisons, old[o]->key == key)) continue;   // already in the tree
+            merged.push_back(new Node(key, items[i].second));
+            insertedOut[i] = 1;
+            ++added;
+        }
+        merged.insert(merged.end(), old.begin() + o, old.end());
+
+        ++rebuildCount;
+        root = buildBalanced(merged, 0, merged.size());
+        count = maxCount = merged.size();
+        return added;
     }
 
     // ----- Public wrapper: Find -----
     // Returns a pointer to the value associated with the key
     // or nullptr if key is not found
     V *find(const K &k) {
-        return findRec(root, k);
+        Node *n = findNode(root, k, comparisons);
+        return n ? &n->val : nullptr;
+    }
+    const V *find(const K &k, int &cmp) const {
+        const Node *n = findNode(root, k, cmp);
+        return n ? &n->val : nullptr;
+    }
+
+    // ----- Public wrapper: Batched Find -----
+    // Looks up keys[0..n) and stores a pointer to each value (or nullptr) in
+    // out[0..n). Runs up to kFindGroup searches in lockstep, one level per
+    // round, and prefetches the node each search visits next, so the cache
+    // misses of a group overlap instead of being paid one after another.
+    // Counts the same comparisons as n calls to find().
+    static constexpr std::size_t kFindGroup = 16;
+    void findMany(const K *keys, std::size_t n, const V **out, int &cmp) const {
+        const Node *cur[kFindGroup];
+        for (std::size_t base = 0; base < n; base += kFindGroup) {
+            std::size_t g = std::min(kFindGroup, n - base);
+            for (std::size_t i = 0; i < g; ++i) {
+                cur[i] = root;
+                out[base + i] = nullptr;
+            }
+            for (bool active = root != nullptr; active; ) {
+                active = false;
+                for (std::size_t i = 0; i < g; ++i) {
+                    const Node *c = cur[i];
+                    if (!c) continue;
+                    const K &k = keys[base + i];
+                    ++cmp;
+                    if (k == c->key) {
+                        out[base + i] = &c->val;
+                        cur[i] = nullptr;
+                        continue;
+                    }
+                    ++cmp;
+                    cur[i] = c = k < c->key ? c->left : c->right;
+                    if (c) {
+                        __builtin_prefetch(c);
+                        active = true;
+                    }
+                }
+            }
+        }
     }
 
     // ----- Public wrapper: Erase -----
     // Removes a node by key if it exists
     // Returns true if a node was deleted, false otherwise
-    bool erase(const K &k) {
+    // (if oldOut is given it receives the removed value)
+    bool erase(const K &k, V *oldOut = nullptr) {
         bool erased = false;
-        root = eraseRec(root, k, erased);
+        root = eraseRec(root, k, erased, oldOut);
+        if (erased) --count;
+        if (erased && alpha < 1.0 && count < alpha * maxCount) {
+            root = rebuild(root, count);
+            maxCount = count;
+        }
         return erased;
     }
 
+    // ----- Public wrapper: Assign -----
+    // Replaces the value stored under k and refreshes the cached Summaries
+    // on its path. Returns false if k is not in the tree.
+    bool assign(const K &k, const V &v) {
+        V *p = find(k);
+        if (!p) return false;
+        *p = v;
+        return refresh(k);
+    }
+
     // ----- Public wrapper: Range Apply -----
     // Applies a function `fn(key, value)` to all nodes with keys in [lo, hi]
+    // (until fn returns false, see visitInRange)
     template <typename Fn>
     void rangeApply(const K &lo, const K &hi, Fn fn) {
-        rangeRec(root, lo, hi, fn);
+        rangeRec<Node>(root, lo, hi, fn, comparisons);
+    }
+    template <typename Fn>
+    void rangeApply(const K &lo, const K &hi, Fn fn, int &cmp) const {
+        rangeRec<const Node>(root, lo, hi, fn, cmp);
+    }
+
+    // ----- Public wrapper: In-order Traversal -----
+    // Applies a function `fn(key, value)` to every node in ascending key order
+    // (does not count comparisons, it is meant for maintenance and statistics)
+    template <typename Fn>
+    void forEach(Fn fn) const {
+        forEachRec(root, fn);
+    }
+
+    // ----- Number of keys currently stored (O(1)) -----
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    // ----- Shape statistics -----
+    // shape() reports node count, height and average depth in O(1) from the
+    // figures every node keeps for its subtree (levelFill stays empty), so it
+    // can be polled as often as a skew check needs. stats() adds how full
+    // every level is, which takes a walk of the whole tree: O(n). Neither
+    // touches the comparison counter.
+    TreeStats shape() const {
+        TreeStats st;
+        st.nodes = count;
+        st.height = root ? root->height : 0;
+        st.maxDepth = st.height - 1;
+        if (root) st.avgDepth = (double)root->depthSum / count;
+        return st;
+    }
+    TreeStats stats() const {
+        TreeStats st = shape();
+        levelFillRec(root, 0, st.levelFill);
+        return st;
+    }
+
+    // ----- Key-range histogram -----
+    // `bounds` must be sorted ascending; bucket i counts keys in [bounds[i], bounds[i+1]).
+    // Keys below bounds.front() or at/above bounds.back() are not counted.
+    // Lets a planner estimate how many rows a range predicate will touch.
+    // O(b log n) for b bounds thanks to the subtree sizes.
+    std::vector<std::size_t> histogram(const std::vector<K> &bounds) const {
+        std::vector<std::size_t> buckets(bounds.size() > 1 ? bounds.size() - 1 : 0, 0);
+        int ignored = 0;
+        for (std::size_t i = 0; i < buckets.size(); ++i)
+            buckets[i] = rankRec(root, bounds[i + 1], false, ignored) -
+                         rankRec(root, bounds[i], false, ignored);
+        return buckets;
     }
 
+    // ----- Order statistics (all O(log n)) -----
+    // Number of keys strictly smaller than k
+    std::size_t rank(const K &k) {
+        return rankRec(root, k, false, comparisons);
+    }
+    std::size_t rank(const K &k, int &cmp) const {
+        return rankRec(root, k, false, cmp);
+    }
+
+    // Value / key of the i-th smallest key (0-based), or nullptr if i >= size()
+    V *select(std::size_t i) {
+        Node *n = selectNode(root, i, comparisons);
+        return n ? &n->val : nullptr;
+    }
+    const V *select(std::size_t i, int &cmp) const {
+        const Node *n = selectNode(root, i, cmp);
+        return n ? &n->val : nullptr;
+    }
+    const K *selectKey(std::size_t i) {
+        Node *n = selectNode(root, i, comparisons);
+        return n ? &n->key : nullptr;
+    }
+
+    // Number of keys in [lo, hi] without visiting them
+    std::size_t countRange(const K &lo, const K &hi) {
+        return countRange(lo, hi, comparisons);
+    }
+    std::size_t countRange(const K &lo, const K &hi, int &cmp) const {
+        if (hi < lo) return 0;
+        return rankRec(root, hi, true, cmp) - rankRec(root, lo, false, cmp);
+    }
+
+    // ----- Range aggregate -----
+    // Summary of all nodes with keys in [lo, hi], combined in key order.
+    // O(log n): whole subtrees inside the range contribute their cached Summary.
+    summary_type aggregateRange(const K &lo, const K &hi) {
+        return aggregateRange(lo, hi, comparisons);
+    }
+    summary_type aggregateRange(const K &lo, const K &hi, int &cmp) const {
+        if (hi < lo) return Summary::identity();
+        return aggregateRec(root, lo, hi, false, false, cmp);
+    }
+
+    // Summary of the whole tree (O(1))
+    summary_type aggregate() const {
+        return root ? root->agg : Summary::identity();
+    }
+
+    // ----- Refresh -----
+    // Recomputes cached Summaries on the path to k. Call after changing a
+    // value in place (through find()) in a way that affects Summary::lift.
+    // Returns false if k is not in the tree.
+    bool refresh(const K &k) {
+        return refreshRec(root, k);
+    }
+
+    // ----- Rebalancing control -----
+    // alpha in (0.5, 1.0]: smaller keeps the tree shallower at the price of
+    // more frequent rebuilds; 1.0 disables rebuilding (plain unbalanced BST).
+    void setBalanceFactor(double a) {
+        alpha = a < 0.5 ? 0.5 : (a > 1.0 ? 1.0 : a);
+        maxCount = count;
+    }
+    double balanceFactor() const { return alpha; }
+    std::size_t rebuilds() const { return rebuildCount; }
+
     // ----- Resets the comparison counter -----
     void resetMetrics() { comparisons = 0; }
 
 private:
+    // ----- Helper: Swap -----
+    void swapWith(BST &other) noexcept {
+        std::swap(root, other.root);
+        std::swap(count, other.count);
+        std::swap(maxCount, other.maxCount);
+        std::swap(alpha, other.alpha);
+        std::swap(rebuildCount, other.rebuildCount);
+        std::swap(comparisons, other.comparisons);
+    }
+
     // ----- Helper: Clear -----
     // Recursively deletes all nodes in the tree (postorder traversal)
     void clear(Node *n) {
@@ -72,53 +406,148 @@ private:
         delete n;
     }
 
+    // ----- Helper: In-order Traversal -----
+    template <typename Fn>
+    static void forEachRec(const Node *n, Fn &fn) {
+        if (!n) return;
+        forEachRec(n->left, fn);
+        fn(n->key, n->val);
+        forEachRec(n->right, fn);
+    }
+
+    // ----- Helper: Level Fill -----
+    // Counts the nodes at every depth (preorder)
+    static void levelFillRec(const Node *n, int depth, std::vector<std::size_t> &levelFill) {
+        if (!n) return;
+        if ((int)levelFill.size() <= depth) levelFill.resize(depth + 1, 0);
+        ++levelFill[depth];
+        levelFillRec(n->left, depth + 1, levelFill);
+        levelFillRec(n->right, depth + 1, levelFill);
+    }
+
+    // ----- Insert bookkeeping -----
+    struct InsertState {
+        bool inserted = false; // a new node was created
+        bool tooDeep = false;  // it landed below the depth limit and no scapegoat was rebuilt yet
+    };
+
+    // ----- Depth limit for n nodes: floor(log_{1/alpha}(n)) -----
+    int depthLimit(std::size_t n) const {
+        if (alpha >= 1.0 || n < 2) return INT_MAX;
+        return (int)std::floor(std::log((double)n) / std::log(1.0 / alpha));
+    }
+
     // ----- Recursive Insert -----
-    // Inserts a key-value pair into subtree rooted at n
-    bool insertRec(Node *&n, const K &k, const V &v) {
+    // Inserts a key-value pair into subtree rooted at n (depth = depth of n)
+    // and bumps the subtree sizes on the way back up. A too-deep insert
+    // rebuilds the first alpha-unbalanced ancestor it unwinds through.
+    void insertRec(Node *&n, const K &k, const V &v, int depth, InsertState &st) {
         if (!n) {
             n = new Node(k, v);  // base case: found empty spot
-            return true;
+            st.inserted = true;
+            st.tooDeep = depth > depthLimit(count + 1);
+            return;
         }
         ++comparisons;
         if (k == n->key)
-            return false; // duplicate key not allowed
+            return; // duplicate key not allowed
         ++comparisons;
-        if (k < n->key)
-            return insertRec(n->left, k, v);   // recurse left
+        bool goLeft = k < n->key;
+        if (goLeft)
+            insertRec(n->left, k, v, depth + 1, st);   // recurse left
         else
-            return insertRec(n->right, k, v);  // recurse right
+            insertRec(n->right, k, v, depth + 1, st);  // recurse right
+        if (!st.inserted)
+            return;
+        pull(n);
+
+        // Unwinding a too-deep insert: n is the scapegoat if the child we came
+        // from holds more than alpha of its weight
+        if (st.tooDeep && sz(goLeft ? n->left : n->right) > alpha * n->size) {
+            n = rebuild(n, n->size);
+            st.tooDeep = false;
+        }
+    }
+
+    // ----- Helper: Subtree Size -----
+    static std::size_t sz(const Node *n) { return n ? n->size : 0; }
+
+    // ----- Helper: Subtree Height and Depth Sum -----
+    static int ht(const Node *n) { return n ? n->height : 0; }
+    static std::size_t depths(const Node *n) { return n ? n->depthSum + n->size : 0; } // as a child
+
+    // ----- Helper: Recompute size, shape and Summary after children changed -----
+    static void pull(Node *n) {
+        n->size = 1 + sz(n->left) + sz(n->right);
+        n->height = 1 + std::max(ht(n->left), ht(n->right));
+        n->depthSum = depths(n->left) + depths(n->right);
+        summary_type a = n->left ? n->left->agg : Summary::identity();
+        a = Summary::combine(a, Summary::lift(n->key, n->val));
+        n->agg = n->right ? Summary::combine(a, n->right->agg) : a;
+    }
+
+    // ----- Rebuild -----
+    // Flattens the subtree rooted at n (holding `size` nodes) and relinks the
+    // same nodes into a perfectly balanced subtree. Returns the new subtree root.
+    Node *rebuild(Node *n, std::size_t size) {
+        ++rebuildCount;
+        std::vector<Node *> nodes;
+        nodes.reserve(size);
+        flatten(n, nodes);
+        return buildBalanced(nodes, 0, nodes.size());
+    }
+
+    // ----- Helper: Flatten (in-order) -----
+    static void flatten(Node *n, std::vector<Node *> &out) {
+        if (!n) return;
+        flatten(n->left, out);
+        out.push_back(n);
+        flatten(n->right, out);
+    }
+
+    // ----- Helper: Build Balanced -----
+    // Links nodes[lo, hi) into a balanced subtree rooted at the middle element
+    static Node *buildBalanced(std::vector<Node *> &nodes, std::size_t lo, std::size_t hi) {
+        if (lo >= hi) return nullptr;
+        std::size_t mid = lo + (hi - lo) / 2;
+        Node *n = nodes[mid];
+        n->left = buildBalanced(nodes, lo, mid);
+        n->right = buildBalanced(nodes, mid + 1, hi);
+        pull(n);
+        return n;
     }
 
     // ----- Recursive Find -----
-    // Searches for key in subtree rooted at n
-    // Returns pointer to value or nullptr if not found
-    V *findRec(Node *n, const K &k) {
+    // Searches for key in subtree rooted at n, charging comparisons to cmp
+    // Returns the node holding the key or nullptr if not found
+    static Node *findNode(Node *n, const K &k, int &cmp) {
         if (!n)
             return nullptr; // base case: not found
-        ++comparisons;
+        ++cmp;
         if (k == n->key)
-            return &n->val; // found it
-        ++comparisons;
+            return n; // found it
+        ++cmp;
         if (k < n->key)
-            return findRec(n->left, k);  // search left
+            return findNode(n->left, k, cmp);  // search left
         else
-            return findRec(n->right, k); // search right
+            return findNode(n->right, k, cmp); // search right
     }
 
     // ----- Recursive Erase -----
     // Removes a node with given key from subtree rooted at n
     // Returns new subtree root after deletion
-    Node *eraseRec(Node *n, const K &k, bool &erased) {
+    Node *eraseRec(Node *n, const K &k, bool &erased, V *oldOut) {
         if (!n) return nullptr;
 
         ++comparisons;
         if (k < n->key)
-            n->left = eraseRec(n->left, k, erased);  // go left
+            n->left = eraseRec(n->left, k, erased, oldOut);  // go left
         else if (n->key < k)
-            n->right = eraseRec(n->right, k, erased); // go right
+            n->right = eraseRec(n->right, k, erased, oldOut); // go right
         else {
             // Found node to delete
             erased = true;
+            if (oldOut) *oldOut = n->val;
 
             // Case 1: no left child
             if (!n->left) {
@@ -136,11 +565,77 @@ private:
             Node *succ = minNode(n->right);   // smallest in right subtree
             n->key = succ->key;
             n->val = succ->val;
-            n->right = eraseRec(n->right, succ->key, erased);
+            n->right = eraseRec(n->right, succ->key, erased, nullptr);
         }
+        if (erased) pull(n);
         return n;
     }
 
+    // ----- Recursive Rank -----
+    // Number of keys < k in subtree n (<= k when inclusive); cmp is the
+    // counter to charge, so const callers can pass a scratch variable
+    static std::size_t rankRec(const Node *n, const K &k, bool inclusive, int &cmp) {
+        if (!n) return 0;
+        ++cmp;
+        bool goRight = inclusive ? !(k < n->key) : n->key < k;
+        if (goRight)
+            return sz(n->left) + 1 + rankRec(n->right, k, inclusive, cmp);
+        return rankRec(n->left, k, inclusive, cmp);
+    }
+
+    // ----- Recursive Range Aggregate -----
+    // loOpen / hiOpen mean every key in subtree n is already known to be
+    // >= lo / <= hi. Once the search paths for lo and hi split, each side
+    // keeps one bound open, so only two root-to-leaf paths are walked.
+    static summary_type aggregateRec(const Node *n, const K &lo, const K &hi,
+                                     bool loOpen, bool hiOpen, int &cmp) {
+        if (!n) return Summary::identity();
+        if (loOpen && hiOpen) return n->agg;
+
+        if (!loOpen) {
+            ++cmp;
+            if (n->key < lo) return aggregateRec(n->right, lo, hi, loOpen, hiOpen, cmp);
+        }
+        if (!hiOpen) {
+            ++cmp;
+            if (hi < n->key) return aggregateRec(n->left, lo, hi, loOpen, hiOpen, cmp);
+        }
+        // n is in range: its left subtree is all <= hi, its right subtree all >= lo
+        summary_type a = aggregateRec(n->left, lo, hi, loOpen, true, cmp);
+        a = Summary::combine(a, Summary::lift(n->key, n->val));
+        return Summary::combine(a, aggregateRec(n->right, lo, hi, true, hiOpen, cmp));
+    }
+
+    // ----- Recursive Refresh -----
+    bool refreshRec(Node *n, const K &k) {
+        if (!n) return false;
+        bool found = true;
+        if (k < n->key)
+            found = refreshRec(n->left, k);
+        else if (n->key < k)
+            found = refreshRec(n->right, k);
+        if (found) pull(n);
+        return found;
+    }
+
+    // ----- Select -----
+    // Walks down by subtree sizes to the node holding the i-th smallest key
+    static Node *selectNode(Node *n, std::size_t i, int &cmp) {
+        while (n) {
+            ++cmp;
+            std::size_t leftSize = sz(n->left);
+            if (i < leftSize) {
+                n = n->left;
+            } else if (i == leftSize) {
+                return n;
+            } else {
+                i -= leftSize + 1;
+                n = n->right;
+            }
+        }
+        return nullptr;
+    }
+
     // ----- Find Minimum Node -----
     // Returns pointer to node with smallest key in subtree
     Node *minNode(Node *n) {
@@ -149,21 +644,23 @@ private:
 
     // ----- Recursive Range Traversal -----
     // Applies fn(key, value) to all nodes with lo <= key <= hi
-    template <typename Fn>
-    void rangeRec(Node *n, const K &lo, const K &hi, Fn fn) {
-        if (!n) return;
+    // (N is Node or const Node, so const callers only see const values)
+    template <typename N, typename Fn>
+    static bool rangeRec(N *n, const K &lo, const K &hi, Fn &fn, int &cmp) {
+        if (!n) return true;
 
-        ++comparisons;
-        if (lo < n->key)
-            rangeRec(n->left, lo, hi, fn);  // explore left if possible
+        ++cmp;
+        if (lo < n->key && !rangeRec<N>(n->left, lo, hi, fn, cmp))
+            return false;                           // explore left if possible
 
-        ++comparisons;
-        if (!(n->key < lo) && !(hi < n->key))
-            fn(n->key, n->val);             // apply function in range
+        ++cmp;
+        if (!(n->key < lo) && !(hi < n->key) && !visitInRange(fn, n->key, n->val))
+            return false;                           // apply function in range
 
-        ++comparisons;
+        ++cmp;
         if (n->key < hi)
-            rangeRec(n->right, lo, hi, fn); // explore right if possible
+            return rangeRec<N>(n->right, lo, hi, fn, cmp); // explore right if possible
+        return true;
     }
 };
 
@@ -0,0 +1,399 @@
+#ifndef COLUMNARFILE_H
+#define COLUMNARFILE_H
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Record.h"
+#include "RecordSink.h"
+#include "MappedRecordStore.h"
+
+// ================== Columnar File ==================
+// Binary, column-oriented archive of records, written in blocks of up to
+// blockRows rows. Every block carries a zone map (min/max of id and gpa)
+// in the footer, and last and major are stored as a per-block dictionary
+// page plus one u16 code per row. The dictionary pages open the block, so a
+// scan can skip a block by its zone map, or by a major dictionary that lacks
+// the wanted value, without reading the block's columns. Layout (native
+// byte order):
+//   header   magic "BSTCOLS1", u32 version, u32 blockRows
+//   block    major dictionary page, last dictionary page,
+//            i32 id[rows], f64 gpa[rows], u16 last code[rows],
+//            first: u32 length[rows], the bytes of all values,
+//            u16 major code[rows]
+//            (dictionary page: u32 entries, u32 length[entries], bytes)
+//   footer   per block: offset, bytes, rows and zone map (ColumnarBlockInfo)
+//   trailer  u64 footer offset, u64 block count
+struct ColumnarBlockInfo {
+    uint64_t offset;     // file offset of the block
+    uint64_t bytes;      // size of the block
+    uint32_t rows;
+    int32_t minId, maxId;
+    uint32_t padding;
+    double minGpa, maxGpa;
+};
+
+// ================== Columnar Writer ==================
+// Record sink (see Engine::exportRangeById) for a ColumnarFile. Records are
+// buffered one block at a time and each full block is encoded and written,
+// so memory stays at one block plus the footer (48 bytes per block) no
+// matter how many records are exported. Engine exports records in ID order,
+// which keeps the id zone maps narrow.
+class ColumnarWriter {
+    static constexpr char kMagic[8] = {'B', 'S', 'T', 'C', 'O', 'L', 'S', '1'};
+    static constexpr uint32_t kVersion = 3;
+    friend class ColumnarReader;
+
+    BufferedFile file;
+    uint32_t blockRows;
+    uint64_t offset = 0;                      // bytes written so far
+    std::vector<Record> pending;              // rows of the current block
+    std::vector<ColumnarBlockInfo> blocks;    // footer
+    size_t rows = 0;
+
+public:
+    static constexpr uint32_t kDefaultBlockRows = 4096;
+    static constexpr uint32_t kMaxBlockRows = 65536;   // dictionary codes are u16
+
+    explicit ColumnarWriter(const std::string &path, uint32_t blockRowsIn = kDefaultBlockRows)
+        : file(path), blockRows(blockRowsIn == 0 || blockRowsIn > kMaxBlockRows ? kDefaultBlockRows : blockRowsIn) {
+        write(kMagic, sizeof(kMagic));
+        put(kVersion);
+        put(blockRows);
+        pending.reserve(blockRows);
+    }
+
+    bool add(const Record &rec) {
+        pending.push_back(rec);
+        ++rows;
+        if (pending.size() == blockRows) writeBlock();
+        return file.good();
+    }
+
+    size_t count() const { return rows; }
+
+    // Writes the last partial block, the footer and the trailer and closes
+    // the file; false on any I/O error
+    bool finish() {
+        writeBlock();
+        uint64_t footerOffset = offset;
+        write(blocks.data(), blocks.size() * sizeof(ColumnarBlockInfo));
+        put(footerOffset);
+        put((uint64_t)blocks.size());
+        return file.close();
+    }
+
+private:
+    void write(const void *data, size_t n) {
+        file.append(data, n);
+        offset += n;
+    }
+    template <typename T>
+    void put(const T &v) { write(&v, sizeof(T)); }
+
+    void writeBlock() {
+        uint32_t n = (uint32_t)pending.size();
+        if (n == 0) return;
+        ColumnarBlockInfo info{};
+        info.offset = offset;
+        info.rows = n;
+        info.minId = INT_MAX;
+        info.maxId = INT_MIN;
+        info.minGpa = std::numeric_limits<double>::infinity();
+        info.maxGpa = -info.minGpa;
+
+        // 1. Dictionary pages first, so a scan can rule the block out by
+        //    major before it reads any column
+        std::vector<uint16_t> majorCodes = writeDictionary(&Record::major);
+        std::vector<uint16_t> lastCodes = writeDictionary(&Record::last);
+
+        // 2. Fixed-width columns, gathering the zone map on the way
+        for (const Record &rec : pending) {
+            put((int32_t)rec.id);
+            info.minId = std::min(info.minId, (int32_t)rec.id);
+            info.maxId = std::max(info.maxId, (int32_t)rec.id);
+        }
+        for (const Record &rec : pending) {
+            put(rec.gpa);
+            info.minGpa = std::min(info.minGpa, rec.gpa);
+            info.maxGpa = std::max(info.maxGpa, rec.gpa);
+        }
+
+        // 3. String columns: codes into the pages above, first as lengths + bytes
+        write(lastCodes.data(), n * sizeof(uint16_t));
+        for (const Record &rec : pending) put((uint32_t)rec.first.size());
+        for (const Record &rec : pending) write(rec.first.data(), rec.first.size());
+        write(majorCodes.data(), n * sizeof(uint16_t));
+
+        info.bytes = offset - info.offset;
+        blocks.push_back(info);
+        pending.clear();
+    }
+
+    // Writes the dictionary page of the column's distinct values (in
+    // first-seen order) and returns each row's code
+    std::vector<uint16_t> writeDictionary(std::string Record::*column) {
+        std::unordered_map<std::string_view, uint16_t> codeOf;
+        std::vector<const std::string *> entries;
+        std::vector<uint16_t> codes;
+        codes.reserve(pending.size());
+        for (const Record &rec : pending) {
+            const std::string &value = rec.*column;
+            auto found = codeOf.emplace(std::string_view(value), (uint16_t)entries.size());
+            if (found.second) entries.push_back(&value);
+            codes.push_back(found.first->second);
+        }
+        put((uint32_t)entries.size());
+        for (const std::string *value : entries) put((uint32_t)value->size());
+        for (const std::string *value : entries) write(value->data(), value->size());
+        return codes;
+    }
+};
+
+// ================== Columnar Scan ==================
+// Conjunctive predicate for ColumnarReader::scan: id and gpa ranges
+// (inclusive) and an optional exact major.
+struct ColumnarPredicate {
+    int minId = INT_MIN;
+    int maxId = INT_MAX;
+    double minGpa = -std::numeric_limits<double>::infinity();
+    double maxGpa = std::numeric_limits<double>::infinity();
+    std::optional<std::string> major;
+};
+
+struct ColumnarScanStats {
+    size_t blocks = 0;              // blocks in the file
+    size_t skippedByZoneMap = 0;    // blocks whose id/gpa range cannot match
+    size_t skippedByDictionary = 0; // blocks whose major dictionary lacks the value
+    size_t rows = 0;                // rows that matched
+    bool ok = true;                 // false if the file could not be opened or a block is corrupt
+};
+
+// ================== Columnar Reader ==================
+// Maps a ColumnarFile and scans it. open() checks the header and loads the
+// footer (the zone maps) only; scan() then visits just the blocks whose
+// zone maps the predicate can meet, reads their dictionary pages (a block
+// whose major dictionary lacks the wanted major ends there), decodes the id
+// and gpa columns, and reads the string columns only if some row qualifies
+// (the major predicate is checked by dictionary code). Matching rows are
+// passed as RecordViews into the mapping, so a view is valid while the
+// reader stays open.
+class ColumnarReader {
+    const char *base = nullptr;
+    size_t length = 0;
+    uint32_t blockRows = 0;
+    std::vector<ColumnarBlockInfo> blocks;
+
+public:
+    ColumnarReader() = default;
+    ColumnarReader(const ColumnarReader &) = delete;
+    ColumnarReader &operator=(const ColumnarReader &) = delete;
+    ~ColumnarReader() { close(); }
+
+    // Maps the file and reads its footer. Returns false (and stays closed)
+    // if the file cannot be mapped or is not a valid columnar file.
+    bool open(const std::string &path) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        void *map = MAP_FAILED;
+        if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+            length = (size_t)st.st_size;
+            map = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        ::close(fd);
+        if (map == MAP_FAILED) {
+            length = 0;
+            return false;
+        }
+        base = static_cast<const char *>(map);
+        if (!readFooter()) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+        if (base) ::munmap(const_cast<char *>(base), length);
+        base = nullptr;
+        length = 0;
+        blocks.clear();
+    }
+
+    bool isOpen() const { return base != nullptr; }
+    const std::vector<ColumnarBlockInfo> &blockInfo() const { return blocks; }
+    size_t rows() const {
+        size_t n = 0;
+        for (const ColumnarBlockInfo &b : blocks) n += b.rows;
+        return n;
+    }
+
+    // Calls fn(const RecordView &) for every row matching pred, in file order
+    template <typename Fn>
+    ColumnarScanStats scan(const ColumnarPredicate &pred, Fn fn) const {
+        ColumnarScanStats stats;
+        stats.ok = isOpen();
+        stats.blocks = blocks.size();
+        BlockScratch scratch;
+        for (const ColumnarBlockInfo &info : blocks) {
+            if (!stats.ok) break;
+            if (info.maxId < pred.minId || info.minId > pred.maxId ||
+                info.maxGpa < pred.minGpa || info.minGpa > pred.maxGpa) {
+                ++stats.skippedByZoneMap;
+                continue;
+            }
+            stats.ok = scanBlock(info, pred, scratch, stats, fn);
+        }
+        return stats;
+    }
+
+private:
+    // Bounds-checked reads from one block
+    struct Cursor {
+        const char *p, *end;
+        bool ok = true;
+        const char *take(size_t n) {
+            if (!ok || (size_t)(end - p) < n) {
+                ok = false;
+                return nullptr;
+            }
+            const char *at = p;
+            p += n;
+            return at;
+        }
+        template <typename T>
+        T get() {
+            T v{};
+            if (const char *at = take(sizeof(T))) std::memcpy(&v, at, sizeof(T));
+            return v;
+        }
+        // n values of T copied out (the mapping gives no alignment)
+        template <typename T>
+        bool array(size_t n, std::vector<T> &out) {
+            const char *at = take(n * sizeof(T));
+            out.resize(n);
+            if (at && n) std::memcpy(out.data(), at, n * sizeof(T));
+            return at != nullptr;
+        }
+    };
+
+    // Per-scan buffers, reused from block to block
+    struct BlockScratch {
+        std::vector<int32_t> ids;
+        std::vector<double> gpas;
+        std::vector<uint32_t> dictLengths, firstLengths;
+        std::vector<uint16_t> lastCodes, majorCodes;
+        std::vector<std::string_view> lastDict, majorDict;
+        std::vector<uint32_t> matches;
+    };
+
+    // Reads a dictionary page into dict (views into the mapping)
+    static bool readDictionary(Cursor &in, size_t rows, std::vector<uint32_t> &lengths,
+                               std::vector<std::string_view> &dict) {
+        uint32_t entries = in.get<uint32_t>();
+        if (!in.ok || entries > rows || !in.array(entries, lengths)) return false;
+        dict.clear();
+        for (uint32_t len : lengths) {
+            const char *text = in.take(len);
+            if (!text) return false;
+            dict.emplace_back(text, len);
+        }
+        return true;
+    }
+
+    template <typename Fn>
+    bool scanBlock(const ColumnarBlockInfo &info, const ColumnarPredicate &pred, BlockScratch &s,
+                   ColumnarScanStats &stats, Fn &fn) const {
+        size_t n = info.rows;
+        Cursor in{base + info.offset, base + info.offset + info.bytes};
+
+        // 1. The dictionary pages; a block without the wanted major ends here
+        if (!readDictionary(in, n, s.dictLengths, s.majorDict) || !readDictionary(in, n, s.dictLengths, s.lastDict))
+            return false;
+        int wanted = -1;
+        if (pred.major) {
+            for (size_t c = 0; c < s.majorDict.size() && wanted < 0; ++c) {
+                if (s.majorDict[c] == *pred.major) wanted = (int)c;
+            }
+            if (wanted < 0) {
+                ++stats.skippedByDictionary;
+                return true;
+            }
+        }
+
+        // 2. id and gpa, then the rows they let through
+        if (!in.array(n, s.ids) || !in.array(n, s.gpas)) return false;
+        s.matches.clear();
+        for (size_t i = 0; i < n; ++i) {
+            if (s.ids[i] >= pred.minId && s.ids[i] <= pred.maxId && s.gpas[i] >= pred.minGpa && s.gpas[i] <= pred.maxGpa)
+                s.matches.push_back((uint32_t)i);
+        }
+        if (s.matches.empty()) return true;
+
+        // 3. The string columns (first is located by its lengths, not copied)
+        if (!in.array(n, s.lastCodes) || !in.array(n, s.firstLengths)) return false;
+        size_t firstBytes = 0;
+        for (uint32_t len : s.firstLengths) firstBytes += len;
+        const char *firstText = in.take(firstBytes);
+        if (!firstText || !in.array(n, s.majorCodes)) return false;
+
+        // 4. Handing out the matching rows (first is found by a running offset)
+        size_t at = 0, offset = 0;
+        for (uint32_t i : s.matches) {
+            for (; at < i; ++at) offset += s.firstLengths[at];
+            if (wanted >= 0 && s.majorCodes[i] != wanted) continue;
+            if (s.lastCodes[i] >= s.lastDict.size() || s.majorCodes[i] >= s.majorDict.size()) return false;
+            RecordView view;
+            view.id = s.ids[i];
+            view.gpa = s.gpas[i];
+            view.last = s.lastDict[s.lastCodes[i]];
+            view.first = std::string_view(firstText + offset, s.firstLengths[i]);
+            view.major = s.majorDict[s.majorCodes[i]];
+            ++stats.rows;
+            fn(view);
+        }
+        return true;
+    }
+
+    bool readFooter() {
+        const size_t header = sizeof(ColumnarWriter::kMagic) + 2 * sizeof(uint32_t);
+        const size_t trailer = 2 * sizeof(uint64_t);
+        if (length < header + trailer) return false;
+        uint32_t version;
+        std::memcpy(&version, base + 8, 4);
+        std::memcpy(&blockRows, base + 12, 4);
+        if (std::memcmp(base, ColumnarWriter::kMagic, 8) != 0 || version != ColumnarWriter::kVersion) return false;
+
+        uint64_t footerOffset, count;
+        std::memcpy(&footerOffset, base + length - trailer, 8);
+        std::memcpy(&count, base + length - trailer + 8, 8);
+        if (footerOffset < header || footerOffset > length - trailer ||
+            count != (length - trailer - footerOffset) / sizeof(ColumnarBlockInfo) ||
+            (length - trailer - footerOffset) % sizeof(ColumnarBlockInfo) != 0)
+            return false;
+        blocks.resize(count);
+        if (count) std::memcpy(blocks.data(), base + footerOffset, count * sizeof(ColumnarBlockInfo));
+        for (const ColumnarBlockInfo &b : blocks) {
+            if (b.offset < header || b.offset > footerOffset || b.bytes > footerOffset - b.offset ||
+                b.rows == 0 || b.rows > blockRows)
+                return false;
+        }
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,214 @@
+#ifndef CSVIMPORTER_H
+#define CSVIMPORTER_H
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "Record.h"
+
+// ================== CSV Import Statistics ==================
+struct CsvImportStats {
+    size_t bytes = 0;       // input size
+    size_t rows = 0;        // lines parsed into records
+    size_t rejected = 0;    // non-empty lines that are not id,last,first,major,gpa
+    bool header = false;    // the first line was a header and skipped
+    size_t inserted = 0;    // rows the engine took (Engine::importCsv; repeated IDs are not)
+};
+
+// ================== CSV Importer ==================
+// Parser for registrar exports with one record per line:
+//   id<d>last<d>first<d>major<d>gpa
+// where <d> is ',' (CSV) or '\t' (TSV). Fields are taken verbatim (no
+// quoting or escaping, no whitespace trimming); a trailing '\r' is dropped,
+// empty lines are skipped, and a first line none of whose fields is a
+// number (such as id,last,first,major,gpa) is treated as a header. Lines
+// with the wrong number of fields or an ID/GPA that does not parse
+// completely, a malformed first line included, are counted as rejected and
+// skipped.
+//
+// The input is mmap'ed and cut into one chunk per thread at line
+// boundaries; every thread parses its chunk into its own vector, and the
+// vectors are concatenated in file order, so the result does not depend on
+// the thread count. Field ends are found 16 bytes at a time with SSE2 where
+// available, and numbers are converted with std::from_chars (no locale, no
+// allocation).
+class CsvImporter {
+public:
+    // Parses the file at path into `out` (appended, in file order).
+    // threads = 0 uses one per hardware thread. Returns false if the file
+    // cannot be read.
+    static bool readFile(const std::string &path, std::vector<Record> &out, CsvImportStats &stats,
+                         char delimiter = ',', unsigned threads = 0) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            return false;
+        }
+        size_t n = (size_t)st.st_size;
+        if (n == 0) {
+            ::close(fd);
+            stats = CsvImportStats{};
+            return true;
+        }
+        void *map = ::mmap(nullptr, n, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (map == MAP_FAILED) return false;
+        ::madvise(map, n, MADV_SEQUENTIAL);
+        parse(static_cast<const char *>(map), n, out, stats, delimiter, threads);
+        ::munmap(map, n);
+        return true;
+    }
+
+    // Parses n bytes of CSV text into `out` (appended, in input order)
+    static void parse(const char *data, size_t n, std::vector<Record> &out, CsvImportStats &stats,
+                      char delimiter = ',', unsigned threads = 0) {
+        stats = CsvImportStats{};
+        stats.bytes = n;
+        const char *p = data, *end = data + n;
+
+        // 1. A header line: no field is a number (a data line with a bad ID
+        //    still has its GPA, and is left to be rejected below)
+        if (isHeader(p, end, delimiter)) {
+            const char *nl = static_cast<const char *>(std::memchr(p, '\n', (size_t)(end - p)));
+            p = nl ? nl + 1 : end;
+            stats.header = true;
+        }
+
+        // 2. Cutting the rest into chunks that end on a newline (a small
+        //    input is not worth a thread)
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        threads = (unsigned)std::min<size_t>(threads, (size_t)(end - p) / kMinChunkBytes + 1);
+        std::vector<const char *> cuts{p};
+        for (unsigned t = 1; t < threads; ++t) {
+            const char *at = std::max(cuts.back(), p + (size_t)(end - p) * t / threads);
+            const char *nl = static_cast<const char *>(std::memchr(at, '\n', (size_t)(end - at)));
+            cuts.push_back(nl ? nl + 1 : end);
+        }
+        cuts.push_back(end);
+
+        // 3. Parsing the chunks in parallel, then appending them in order
+        std::vector<std::vector<Record>> parts(threads);
+        std::vector<size_t> rejected(threads, 0);
+        if (threads == 1) {
+            rejected[0] = parseChunk(cuts[0], cuts[1], delimiter, parts[0]);
+        } else {
+            std::vector<std::thread> workers;
+            for (unsigned t = 0; t < threads; ++t) {
+                workers.emplace_back([&, t] { rejected[t] = parseChunk(cuts[t], cuts[t + 1], delimiter, parts[t]); });
+            }
+            for (std::thread &w : workers) w.join();
+        }
+        size_t total = out.size();
+        for (const std::vector<Record> &part : parts) total += part.size();
+        out.reserve(total);
+        for (unsigned t = 0; t < threads; ++t) {
+            stats.rows += parts[t].size();
+            stats.rejected += rejected[t];
+            std::move(parts[t].begin(), parts[t].end(), std::back_inserter(out));
+        }
+    }
+
+    // Parses whole lines in [p, end) into `out`; returns the rejected line count
+    static size_t parseChunk(const char *p, const char *end, char delimiter, std::vector<Record> &out) {
+        out.reserve(out.size() + (size_t)(end - p) / kTypicalLineBytes);
+        size_t rejected = 0;
+        const char *fields[kFields + 1];
+        while (p < end) {
+            // Field boundaries: fields[i] is where field i starts
+            fields[0] = p;
+            size_t count = 0;
+            const char *q = p;
+            while (true) {
+                q = scanField(q, end, delimiter);
+                ++count;
+                if (q == end || *q == '\n' || count > kFields) break;
+                fields[count] = ++q;
+            }
+            const char *lineEnd = q;
+            if (count > kFields) {   // too many fields: skip the rest of the line
+                const char *nl = static_cast<const char *>(std::memchr(q, '\n', (size_t)(end - q)));
+                lineEnd = nl ? nl : end;
+            }
+            p = lineEnd < end ? lineEnd + 1 : end;
+
+            const char *last = lineEnd;
+            if (last > fields[0] && last[-1] == '\r') --last;
+            if (count == 1 && last == fields[0]) continue;   // empty line
+            if (count != kFields) {
+                ++rejected;
+                continue;
+            }
+
+            // fields[i + 1] - 1 is the delimiter that ends field i
+            Record rec;
+            if (!parseNumber(fields[0], fields[1] - 1, rec.id) || !parseNumber(fields[4], last, rec.gpa)) {
+                ++rejected;
+                continue;
+            }
+            rec.last.assign(fields[1], fields[2] - 1);
+            rec.first.assign(fields[2], fields[3] - 1);
+            rec.major.assign(fields[3], fields[4] - 1);
+            out.push_back(std::move(rec));
+        }
+        return rejected;
+    }
+
+private:
+    static constexpr size_t kFields = 5;
+    static constexpr size_t kTypicalLineBytes = 32;     // reserve() estimate
+    static constexpr size_t kMinChunkBytes = 1 << 20;   // smallest chunk handed to a thread
+
+    // First delimiter or '\n' at or after p (end if none)
+    static const char *scanField(const char *p, const char *end, char delimiter) {
+#if defined(__SSE2__)
+        const __m128i delim = _mm_set1_epi8(delimiter), newline = _mm_set1_epi8('\n');
+        while (end - p >= 16) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+            int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block, delim), _mm_cmpeq_epi8(block, newline)));
+            if (mask) return p + __builtin_ctz((unsigned)mask);
+            p += 16;
+        }
+#endif
+        while (p < end && *p != delimiter && *p != '\n') ++p;
+        return p;
+    }
+
+    // Whether the line at p is non-empty and none of its fields is a number
+    static bool isHeader(const char *p, const char *end, char delimiter) {
+        const char *nl = static_cast<const char *>(std::memchr(p, '\n', (size_t)(end - p)));
+        const char *lineEnd = nl ? nl : end;
+        if (lineEnd > p && lineEnd[-1] == '\r') --lineEnd;
+        if (lineEnd == p) return false;
+        for (const char *field = p;; ++field) {
+            const char *q = scanField(field, lineEnd, delimiter);
+            double value;
+            if (q > field && parseNumber(field, q, value)) return false;
+            if (q == lineEnd) return true;
+            field = q;
+        }
+    }
+
+    // Whole of [p, end) as a number
+    template <typename T>
+    static bool parseNumber(const char *p, const char *end, T &out) {
+        auto [next, ec] = std::from_chars(p, end, out);
+        return ec == std::errc() && next == end;
+    }
+};
+
+#endif
@@ -4,8 +4,33 @@
 #include <iostream>   
 #include <vector>
 #include <algorithm>     
+#include <array>
+#include <climits>
+#include <atomic>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <set>
+#include <shared_mutex>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
 #include "BST.h"      
+#include "SplayTree.h"
+#include "Treap.h"
+#include "OLCBTree.h"
+#include "SkipList.h"
+#include "PersistentBST.h"
+#include "Postings.h"
+#include "Epoch.h"
 #include "Record.h"
+#include "RecordHeap.h"
+#include "SnapshotFile.h"
+#include "MappedRecordStore.h"
+#include "WriteAheadLog.h"
+#include "CsvImporter.h"
+#include "RecordSink.h"
+#include "ColumnarFile.h"
 //add header files as needed
 
 using namespace std;
@@ -16,64 +41,645 @@ static inline string toLower(string s) {
     return s;
 }
 
+// ================== Engine Statistics ==================
+// Row counts plus the shape of both indexes. Row counters are maintained
+// incrementally by insertRecord/deleteById; tree and postings figures are
+// gathered by one walk over each index.
+struct EngineStats {
+    size_t liveRows = 0;          // rows reachable through the indexes
+    size_t tombstonedRows = 0;    // rows soft-deleted (including reclaimed ones)
+    size_t reclaimedRows = 0;     // tombstoned rows whose heap chunk compact() freed
+    size_t deadVersions = 0;      // deleted versions kept for open read views
+    TreeStats idTree;             // shape of idIndex
+    TreeStats lastTree;           // shape of lastIndex
+    size_t distinctLastNames = 0; // number of keys in lastIndex
+    size_t maxPostings = 0;       // longest postings list in lastIndex
+    double avgPostings = 0.0;     // mean postings list length
+    size_t postingsBytes = 0;     // memory held by the compressed postings lists
+    vector<size_t> postingsLog2;  // postingsLog2[b] = surnames with 2^b <= postings < 2^(b+1)
+};
+
+// ================== ID Index Entry ==================
+// Value stored in idIndex: the row's position in the heap plus a copy of its
+// GPA, so GPA aggregates can be maintained inside the tree without reading rows.
+struct IdEntry {
+    int recordID = -1;  // RID (position in Engine::heap)
+    double gpa = 0.0;   // copy of heap[recordID].gpa
+};
+
+// ================== Record Patch ==================
+// Column changes for updateById: only the fields that are set are written.
+// The ID is the primary key and cannot be patched (delete and reinsert).
+struct RecordPatch {
+    optional<string> last;
+    optional<string> first;
+    optional<string> major;
+    optional<double> gpa;
+
+    void applyTo(Record &r) const {
+        if (last) r.last = *last;
+        if (first) r.first = *first;
+        if (major) r.major = *major;
+        if (gpa) r.gpa = *gpa;
+    }
+};
+
+// ================== Log Records ==================
+// Kinds of the WriteAheadLog records an engine writes once a log is attached
+// (payloads: insert = id, last, first, major, gpa; delete = id; update = id,
+// a bit mask of the patched columns, then those columns in RecordPatch order)
+enum LogKind : uint8_t { kLogInsert = 1, kLogDelete = 2, kLogUpdate = 3 };
+
+// ================== GPA Summary ==================
+// Subtree aggregate for idIndex (see NoSummary in BST.h): count, sum, min
+// and max of GPA, enough for COUNT/SUM/AVG/MIN/MAX over any ID range.
+struct GpaSummary {
+    struct value_type {
+        size_t count = 0;
+        double sum = 0.0;
+        double min = 0.0;   // only meaningful when count > 0
+        double max = 0.0;
+        double avg() const { return count ? sum / count : 0.0; }
+    };
+    static value_type identity() { return {}; }
+    static value_type lift(const int &, const IdEntry &e) { return {1, e.gpa, e.gpa, e.gpa}; }
+    static value_type combine(const value_type &a, const value_type &b) {
+        if (!a.count) return b;
+        if (!b.count) return a;
+        return {a.count + b.count, a.sum + b.sum, std::min(a.min, b.min), std::max(a.max, b.max)};
+    }
+};
+
+// ================== Reader-Writer Latch ==================
+// Writer-preferring reader-writer lock. glibc's shared_mutex lets a steady
+// stream of readers starve writers forever, so new readers step aside while
+// a writer is waiting. Usable with unique_lock, shared_lock and scoped_lock.
+class RWLatch {
+    shared_mutex m;
+    atomic<int> writersWaiting{0};
+public:
+
+    void lock() {
+        ++writersWaiting;
+        m.lock();
+        --writersWaiting;
+    }
+    bool try_lock() { return m.try_lock(); }
+    void unlock() { m.unlock(); }
+
+    void lock_shared() {
+        while (writersWaiting.load(memory_order_acquire) != 0)
+            this_thread::yield();
+        m.lock_shared();
+    }
+    void unlock_shared() { m.unlock_shared(); }
+};
+
+// Holds a latch shared, or exclusively when `exclusive` is set. Engine uses
+// it where the mode depends on the index type: reads of a self-adjusting
+// index and writes to a non-concurrent one need the latch exclusively.
+class LatchGuard {
+    RWLatch &latch;
+    bool exclusive;
+public:
+    LatchGuard(RWLatch &latchIn, bool exclusiveIn) : latch(latchIn), exclusive(exclusiveIn) {
+        if (exclusive) latch.lock(); else latch.lock_shared();
+    }
+    ~LatchGuard() {
+        if (exclusive) latch.unlock(); else latch.unlock_shared();
+    }
+    LatchGuard(const LatchGuard &) = delete;
+    LatchGuard &operator=(const LatchGuard &) = delete;
+};
+
+// Read-side guard for the id queries. Holds `latch` like LatchGuard, except
+// that readers of a concurrent idIndex skip it and run lock-free. Every query
+// also runs inside an EpochGuard, so a row it reaches stays allocated until
+// it returns even if a writer deletes the row and compact() frees its chunk.
+class QueryGuard {
+    RWLatch *held = nullptr;
+    bool exclusive;
+    EpochGuard epoch;
+public:
+    QueryGuard(RWLatch &latch, bool exclusiveIn, bool lockFree) : exclusive(exclusiveIn) {
+        if (lockFree) return;
+        held = &latch;
+        if (exclusive) latch.lock(); else latch.lock_shared();
+    }
+    ~QueryGuard() {
+        if (!held) return;
+        if (exclusive) held->unlock(); else held->unlock_shared();
+    }
+    QueryGuard(const QueryGuard &) = delete;
+};
+
+// Makes a write durable when its scope ends: it waits until the log records
+// the write appended (up to `lsn`) are on disk. Writers declare it before
+// their latch guards, so the wait happens after the latches are released and
+// concurrent writers end up sharing one fsync (see WriteAheadLog::commit).
+// A destructor cannot hand back the commit result; a failed commit leaves
+// the log failed, which callers read through BasicEngine::logFailed().
+class LogCommit {
+    WriteAheadLog *log;
+public:
+    uint64_t lsn = 0;   // last record appended by this write (0: none)
+    explicit LogCommit(WriteAheadLog *logIn) : log(logIn) {}
+    ~LogCommit() {
+        if (log && lsn) log->commit(lsn);
+    }
+    LogCommit(const LogCommit &) = delete;
+    LogCommit &operator=(const LogCommit &) = delete;
+};
+
+// Detects an idIndex with a bulk insertSorted(items, insertedOut) (see BST);
+// insertBatch falls back to single inserts in key order for the others.
+template <typename T, typename = void>
+struct HasInsertSorted : false_type {};
+template <typename T>
+struct HasInsertSorted<T, void_t<decltype(declval<T &>().insertSorted(
+    declval<const vector<pair<int, IdEntry>> &>(), declval<vector<char> &>()))>> : true_type {};
+
+// Detects an idIndex with a batched findMany(keys, n, out, cmp) (see BST)
+template <typename T, typename = void>
+struct HasFindMany : false_type {};
+template <typename T>
+struct HasFindMany<T, void_t<decltype(declval<const T &>().findMany(
+    declval<const int *>(), size_t(), declval<const IdEntry **>(), declval<int &>()))>> : true_type {};
+
 // ================== Index Engine ==================
 // Acts like a small "database engine" that manages records and two BST indexes:
-// 1) idIndex: maps student_id → record index (unique key)
-// 2) lastIndex: maps lowercase(last_name) → list of record indices (non-unique key)
-struct Engine {
-    vector<Record> heap;                  // the main data store (simulates a heap file)
-    BST<int, int> idIndex;                // index by student ID
-    BST<string, vector<int>> lastIndex;   // index by last name (can have duplicates)
+// 1) idIndex: maps student_id → record index and GPA (unique key)
+// 2) lastIndex: maps lowercase(last_name) → sorted Postings of record indices (non-unique key)
+// IdIndex - ordered int → IdEntry index type for idIndex (BST with GpaSummary
+//           by default, SplayBST for skewed hot-key lookups, Treap for O(log n)
+//           range detach/attach, OLCBTree or SkipList for parallel writers,
+//           PersistentBST for snapshots); it must provide insert/find/erase/
+//           rangeApply/forEach/stats, find(k, cmp)/rangeApply(lo, hi, fn, cmp)
+//           with a caller-owned counter, assign, and the `selfAdjusting` /
+//           `concurrent` / `persistent` flags.
+//
+// Rows are versioned (see Read Views below): every write takes the next
+// commit timestamp from `clock`, and queries on the engine itself read the
+// current versions.
+//
+// Thread safety: the public methods may be called from many threads at once.
+// Queries hold `latch` shared (exclusive for a self-adjusting idIndex, none
+// at all for a concurrent one) and count comparisons in a local variable, so
+// readers never write shared state. insertRecord/deleteById hold it
+// exclusively, unless idIndex is concurrent: then they hold it shared, rely
+// on the index for idIndex and on the append-only heap for rows, and only
+// serialize on `lastLatch` for the postings update and, per ID, on a
+// stripe mutex (see lockId). detachById/attach/stats always hold it
+// exclusively against concurrent writers. Rows never move and their strings
+// are never rewritten (updateById writes a new version unless only the GPA
+// changes), so returned `const Record *` stay valid while later rows are
+// appended or updated; once a row is deleted or replaced, its pointer is
+// only safe until a compact() that frees its chunk, unless the caller holds
+// an EpochGuard across the query and the use of the pointer.
+// Touching the data members directly bypasses the latches and is only safe
+// single-threaded.
+template <typename IdIndex = BST<int, IdEntry, GpaSummary>>
+struct BasicEngine {
+    RecordHeap heap;                      // the main data store (simulates a heap file)
+    IdIndex idIndex;                      // index by student ID
+    BST<string, Postings> lastIndex;      // index by last name (can have duplicates)
+    atomic<size_t> liveRows{0};           // heap rows not marked deleted
+    mutable RWLatch latch;                // engine-wide latch (see above)
+    mutable RWLatch lastLatch;            // guards lastIndex and `garbage`
+    atomic<uint64_t> clock{0};            // last commit timestamp handed out
+    static constexpr size_t kIdStripes = 64;
+    array<mutex, kIdStripes> idStripes;   // orders concurrent writers of one ID (see lockId)
+
+    // A deleted version kept in the indexes because an open read view may still see it
+    struct DeadVersion {
+        int id;           // student ID of the record
+        int recordID;     // RID of the version
+        uint64_t endTs;   // commit timestamp of the delete
+    };
+    vector<DeadVersion> garbage;          // versions waiting for collectVersions()
+    mutable mutex viewMutex;              // guards viewTimestamps
+    multiset<uint64_t> viewTimestamps;    // read timestamps of open ReadViews and Snapshots
+    atomic<int> openSnapshots{0};         // open Snapshots (they pin every version)
+    WriteAheadLog *wal = nullptr;         // where writes are logged (attachLog), if anywhere
+    uint64_t logPosition = 0;             // LSN of the last logged write the rows reflect (load/replay)
+
+    BasicEngine() = default;
+
+    // Moving hands a freshly built engine to the caller (detachById); the
+    // source must not be in use by other threads and must have no open read
+    // views. Latches are not moved.
+    BasicEngine(BasicEngine &&other) noexcept
+        : heap(std::move(other.heap)), idIndex(std::move(other.idIndex)),
+          lastIndex(std::move(other.lastIndex)), liveRows(other.liveRows.load()),
+          clock(other.clock.load()), garbage(std::move(other.garbage)), logPosition(other.logPosition) {
+        other.liveRows = 0;
+    }
 
     // Inserts a new record and updates both indexes.
-    // Returns the record ID (RID) in the heap.
+    // Returns the record ID (RID) in the heap, or -1 if the ID already exists
+    // (the appended row is then left tombstoned and unindexed).
     int insertRecord(const Record &recIn) {
-        int recordID = heap.size();
+        LogCommit durable(wal);
+        LatchGuard guard(latch, !IdIndex::concurrent);
+        unique_lock<mutex> idLock = lockId(recIn.id);
+        uint64_t ts = ++clock;
 
-        // 1. Adding the record to the heap
-        heap.push_back(recIn);
+        // 1. Adding the record to the heap as a version that begins at ts
+        int recordID = heap.append(recIn, ts);
 
-        // 2. Adding the record to the idIndex BST
-        idIndex.insert(recIn.id, recordID);
+        // 2. Adding the record to the idIndex BST (or on top of a deleted
+        //    version that open read views still see)
+        IdEntry entry{recordID, recIn.gpa};
+        if (!idIndex.insert(recIn.id, entry) && !reviveId(recIn.id, entry)) {
+            unique_lock<RWLatch> postings(lastLatch);
+            heap.endVersion(recordID, ts);
+            heap.retireRow(recordID);
+            return -1;
+        }
 
-        // 3. Adding the record to the lastIndex BST
-        string lastName = toLower(recIn.last);
-        vector<int> *records = lastIndex.find(lastName);
-        if(!records) 
+        // 3. Adding the record to the lastIndex BST (and to the log)
         {
-            // Case if there are no previous records with the same last name
-            lastIndex.insert(lastName, vector<int>{recordID});
+            unique_lock<RWLatch> postings(lastLatch);
+            addPosting(toLower(recIn.last), recordID);
+            logInsert(durable, recIn);
         }
-        else 
+
+        ++liveRows;
+        return recordID;
+    }
+
+    // Inserts a batch of records (the ingest path). Gives the same result as
+    // insertRecord on each row in order (a repeated or existing ID is
+    // skipped), but the batch takes one heap reservation, idIndex receives
+    // the keys in ascending order (merged in one pass where the index has
+    // insertSorted), and each surname is lowercased once and its postings
+    // list looked up once for the whole batch. All rows commit under one
+    // timestamp, so a read view sees either the whole batch or none of it.
+    // Returns the number of rows inserted.
+    size_t insertBatch(const Record *rows, size_t n) {
+        if (n == 0) return 0;
+        LogCommit durable(wal);
+        LatchGuard guard(latch, !IdIndex::concurrent);
+        vector<unique_lock<mutex>> idLocks = lockAllIds();
+        uint64_t ts = ++clock;
+
+        // 1. Adding the whole batch to the heap
+        int firstID = (int)heap.appendBatch(rows, n, ts);
+
+        // 2. Adding the keys to idIndex in ascending ID order (stable, so the
+        //    first of several rows with the same ID wins)
+        vector<int> order(n);
+        iota(order.begin(), order.end(), 0);
+        stable_sort(order.begin(), order.end(), [&](int a, int b) { return rows[a].id < rows[b].id; });
+
+        vector<char> inserted(n, 0);
+        if constexpr (HasInsertSorted<IdIndex>::value) {
+            vector<pair<int, IdEntry>> items;
+            items.reserve(n);
+            for (int i : order) {
+                items.push_back({rows[i].id, IdEntry{firstID + i, rows[i].gpa}});
+            }
+            vector<char> insertedSorted;
+            idIndex.insertSorted(items, insertedSorted);
+            for (size_t j = 0; j < n; ++j) {
+                inserted[order[j]] = insertedSorted[j];
+            }
+        } else {
+            for (int i : order) {
+                inserted[i] = idIndex.insert(rows[i].id, IdEntry{firstID + i, rows[i].gpa});
+            }
+        }
+        for (int i : order) {
+            if (!inserted[i]) inserted[i] = reviveId(rows[i].id, IdEntry{firstID + i, rows[i].gpa});
+        }
+
+        // 3. Adding the postings grouped by surname (sorted, so RIDs stay ascending per name)
+        vector<pair<string, int>> byLast;
+        byLast.reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            if (inserted[i]) byLast.push_back({toLower(rows[i].last), firstID + (int)i});
+        }
+        sort(byLast.begin(), byLast.end());
         {
-            // Case if a record with the same last name exists
-            records->push_back(recordID);
+            unique_lock<RWLatch> postings(lastLatch);
+            for (size_t i = 0; i < n; ++i) {
+                if (!inserted[i]) {
+                    heap.endVersion(firstID + i, ts);
+                    heap.retireRow(firstID + i);
+                } else {
+                    logInsert(durable, rows[i]);
+                }
+            }
+            for (size_t b = 0, e = 0; b < byLast.size(); b = e) {
+                const string &lastName = byLast[b].first;
+                Postings *records = lastIndex.find(lastName);
+                if (!records) {
+                    lastIndex.insert(lastName, Postings());
+                    records = lastIndex.find(lastName);
+                }
+                for (e = b; e < byLast.size() && byLast[e].first == lastName; ++e) {
+                    records->add(byLast[e].second);
+                }
+            }
         }
+
+        liveRows += byLast.size();
+        return byLast.size();
+    }
+    size_t insertBatch(const vector<Record> &rows) {
+        return insertBatch(rows.data(), rows.size());
     }
 
     // Deletes a record logically (marks as deleted and updates indexes)
     // Returns true if deletion succeeded.
     bool deleteById(int id) {
-        int *recordIDptr = idIndex.find(id);
-        if(!recordIDptr) {
+        LogCommit durable(wal);
+        LatchGuard guard(latch, !IdIndex::concurrent);
+        unique_lock<mutex> idLock = lockId(id);
+        uint64_t ts = ++clock;
+
+        // Open read views may still need the version: only close it
+        if (viewsOpen()) {
+            return endLater(id, ts, durable);
+        }
+
+        // 1. Removing the record from idIndex (and learning its RID)
+        IdEntry entry;
+        if(!takeIdEntry(id, entry)) {
+            return false;
+        }
+        int recordID = entry.recordID;
+
+        {
+            unique_lock<RWLatch> postings(lastLatch);
+
+            // 2. Soft deleting the record from the heap by closing its version
+            heap.endVersion(recordID, ts);
+
+            // 3. Removing the record from lastIndex
+            removePosting(toLower(heap[recordID].last), recordID);
+            heap.retireRow(recordID);
+            logDelete(durable, id);
+        }
+
+        --liveRows;
+        return true;
+    }
+
+    // Delete while read views are open: closes the current version of id at
+    // ts but leaves it in both indexes, queued for collectVersions().
+    bool endLater(int id, uint64_t ts, LogCommit &durable) {
+        auto entry = idIndex.find(id);
+        if (!entry) {
+            return false;
+        }
+        int recordID = entry->recordID;
+
+        {
+            unique_lock<RWLatch> postings(lastLatch);
+            if (!heap.endVersion(recordID, ts)) {
+                return false;   // already deleted (possibly by a racing writer)
+            }
+            garbage.push_back({id, recordID, ts});
+            logDelete(durable, id);
+        }
+
+        --liveRows;
+        return true;
+    }
+
+    // Insert of an ID whose current version is deleted but still indexed for
+    // open read views: the new version (entry) replaces it in idIndex and
+    // links back to it. Returns false if the ID's current version is live.
+    bool reviveId(int id, const IdEntry &entry) {
+        unique_lock<RWLatch> postings(lastLatch);
+        auto current = idIndex.find(id);
+        if (!current) {
+            return false;
+        }
+        int oldID = current->recordID;
+        if (heap.endTs(oldID) == RecordHeap::kLive) {
+            return false;
+        }
+        heap.setPrevVersion(entry.recordID, oldID);
+        return idIndex.assign(id, entry);
+    }
+
+    // Changes the columns set in `patch` on the record with this ID and only
+    // maintains the indexes whose keys change: the postings move when the
+    // (lowercased) last name changes, and the GPA copy in idIndex is rewritten
+    // when the GPA changes. A patch that only touches fixed-width columns
+    // (the GPA) is written into the row in place. Any string change makes the
+    // patched row a new version instead, like a delete plus reinsert, because
+    // callers may still hold a `const Record *` to the old row and rewriting
+    // its strings would free memory under them; the old row then lives on
+    // until compact(). Read views, and a concurrent idIndex (whose readers
+    // take no latch), always get a new version. Always holds the latch
+    // exclusively. Returns false if no live record has this ID.
+    bool updateById(int id, const RecordPatch &patch) {
+        LogCommit durable(wal);
+        unique_lock<RWLatch> guard(latch);
+
+        // 1. Finding the current version of the record
+        auto entry = idIndex.find(id);
+        if(!entry || heap.endTs(entry->recordID) != RecordHeap::kLive) {
             return false;
         }
+        logUpdate(durable, id, patch);
+        int recordID = entry->recordID;
+        double oldGpa = entry->gpa;
+
+        Record updated = heap[recordID];
+        patch.applyTo(updated);
+        string oldLast = toLower(heap[recordID].last), newLast = toLower(updated.last);
+
+        // 2a. Only the GPA changes and no view can see the old value:
+        //     overwrite it, no string is reallocated
+        const Record &old = heap[recordID];
+        bool stringsSame = updated.last == old.last && updated.first == old.first && updated.major == old.major;
+        if (stringsSame && !IdIndex::concurrent && !viewsOpen()) {
+            heap[recordID].gpa = updated.gpa;
+            if (updated.gpa != oldGpa) {
+                idIndex.assign(id, IdEntry{recordID, updated.gpa});
+            }
+            return true;
+        }
+
+        // 2b. Otherwise the patched row becomes the record's next version
+        //     (its new RID is the largest, so it joins its postings at the end)
+        uint64_t ts = ++clock;
+        int newID = heap.append(updated, ts, recordID);
+        idIndex.assign(id, IdEntry{newID, updated.gpa});   // before the old version ends (see indexedVersionAt)
+
+        unique_lock<RWLatch> postings(lastLatch);
+        heap.endVersion(recordID, ts);
+        addPosting(newLast, newID);
+        if (viewsOpen()) {
+            garbage.push_back({id, recordID, ts});
+        } else {
+            heap.setPrevVersion(newID, -1);
+            removePosting(oldLast, recordID);
+            heap.retireRow(recordID);
+        }
+        return true;
+    }
+
+    // Writers of a concurrent idIndex share `latch`, so two of them can
+    // change one ID at once. Each holds the ID's stripe from its idIndex step
+    // until its postings and log record are done: a delete then never lands
+    // between an insert's idIndex step and its posting (which would leave a
+    // posting to a retired row), and the log lists an ID's writes in the
+    // order they took effect. Batches hold every stripe (in order, so they
+    // cannot deadlock). No-ops when `latch` already excludes other writers.
+    unique_lock<mutex> lockId(int id) {
+        if (!IdIndex::concurrent) return unique_lock<mutex>();
+        return unique_lock<mutex>(idStripes[(unsigned)id % kIdStripes]);
+    }
+    vector<unique_lock<mutex>> lockAllIds() {
+        vector<unique_lock<mutex>> held;
+        if (IdIndex::concurrent) {
+            for (mutex &stripe : idStripes) held.emplace_back(stripe);
+        }
+        return held;
+    }
+
+    // Removes id from idIndex and hands back its entry in one descent (for a
+    // concurrent index also in one atomic step, so of two racing deletes only
+    // one succeeds).
+    bool takeIdEntry(int id, IdEntry &out) {
+        return idIndex.erase(id, &out);
+    }
+
+    // Deletes many records at once (e.g. withdrawing a cohort). Same result as
+    // deleteById on each ID, but the IDs leave idIndex in ascending order,
+    // and the deleted RIDs are grouped by surname so that each postings list
+    // is looked up once for the whole batch instead of once per row.
+    // Returns the number of records deleted.
+    size_t deleteBatch(const int *ids, size_t n) {
+        LogCommit durable(wal);
+        LatchGuard guard(latch, !IdIndex::concurrent);
+        vector<unique_lock<mutex>> idLocks = lockAllIds();
+        uint64_t ts = ++clock;
+        vector<int> sorted(ids, ids + n);
+        sort(sorted.begin(), sorted.end());
+        sorted.erase(unique(sorted.begin(), sorted.end()), sorted.end());
 
-        // 1. Soft deleting the record from the heap by setting deleted to true
-        int recordID = *recordIDptr;
-        heap[recordID].deleted = true;
+        // Open read views may still need the versions: only close them
+        if (viewsOpen()) {
+            size_t deleted = 0;
+            for (int id : sorted) {
+                deleted += endLater(id, ts, durable);
+            }
+            return deleted;
+        }
+
+        // 1. Removing the IDs from idIndex (and learning their RIDs)
+        vector<pair<string, int>> byLast;
+        for (int id : sorted) {
+            IdEntry entry;
+            if (takeIdEntry(id, entry)) {
+                byLast.push_back({toLower(heap[entry.recordID].last), entry.recordID});
+            }
+        }
+        sort(byLast.begin(), byLast.end());
+
+        // 2. Closing the versions and updating every affected postings list once
+        {
+            unique_lock<RWLatch> postings(lastLatch);
+            vector<int> recordIDs;
+            for (size_t b = 0, e = 0; b < byLast.size(); b = e) {
+                recordIDs.clear();
+                for (e = b; e < byLast.size() && byLast[e].first == byLast[b].first; ++e) {
+                    heap.endVersion(byLast[e].second, ts);
+                    recordIDs.push_back(byLast[e].second);
+                }
+                removePostings(byLast[b].first, recordIDs);
+                for (int recordID : recordIDs) {
+                    logDelete(durable, heap[recordID].id);
+                    heap.retireRow(recordID);
+                }
+            }
+        }
+
+        liveRows -= byLast.size();
+        return byLast.size();
+    }
+    size_t deleteBatch(const vector<int> &ids) {
+        return deleteBatch(ids.data(), ids.size());
+    }
+
+    // Applies `fn(recordID, row)` to the current version of every live
+    // record in ascending ID order (caller holds `latch` so that no writer
+    // runs, exclusively for a concurrent idIndex)
+    template <typename Fn>
+    void forEachCurrent(Fn fn) const {
+        idIndex.forEach([&](const int &, const IdEntry &entry) {
+            int recordID = versionAt(entry.recordID, RecordHeap::kNow);
+            if (recordID >= 0) fn(recordID, heap[recordID]);
+        });
+    }
+
+    // Follows the version chain from the RID stored in idIndex back to the
+    // version a reader at timestamp S sees; -1 if the record did not exist
+    // at S (not yet inserted, or already deleted).
+    int versionAt(int recordID, uint64_t S) const {
+        while (recordID >= 0 && heap.beginTs(recordID) > S) {
+            recordID = heap.prevVersion(recordID);
+        }
+        return recordID >= 0 && S < heap.endTs(recordID) ? recordID : -1;
+    }
+
+    // versionAt for a RID a query read from idIndex without a latch. An
+    // update on a concurrent idIndex publishes the new version in idIndex
+    // before it closes the old one, so such a reader can find the version it
+    // holds closed while the record lives on. It then reads the ID's entry
+    // again and follows it to the newer version; only a deleted record (the
+    // entry is gone or still names this RID) yields -1. A reader at an older
+    // S never needs this: the writes it would miss end versions after S.
+    int indexedVersionAt(int recordID, uint64_t S) const {
+        for (;;) {
+            int found = versionAt(recordID, S);
+            if constexpr (IdIndex::concurrent) {
+                if (found < 0 && S == RecordHeap::kNow) {
+                    auto entry = idIndex.find(heap[recordID].id);
+                    if (entry && entry->recordID != recordID) {
+                        recordID = entry->recordID;
+                        continue;
+                    }
+                }
+            }
+            return found;
+        }
+    }
 
-        // 2. Removing the record from idIndex
-        idIndex.erase(id);
+    // Adds a record ID to the postings list of a (lowercased) last name
+    // (caller holds lastLatch or the engine latch exclusively, as for removePosting)
+    void addPosting(const string &lastName, int recordID) {
+        Postings *records = lastIndex.find(lastName);
+        if(!records) 
+        {
+            // Case if there are no previous records with the same last name
+            Postings fresh;
+            fresh.add(recordID);
+            lastIndex.insert(lastName, fresh);
+        }
+        else 
+        {
+            // Case if a record with the same last name exists (O(1) unless
+            // the RID is older than the list's newest, see Postings::add)
+            records->add(recordID);
+        }
+    }
 
-        // 3. Removing the record from lastIndex
+    // Removes a record ID from the postings list of a (lowercased) last name
+    void removePosting(const string &lastName, int recordID) {
         // Need to account for if the record is part of a list already or not
-        string lastName = toLower(heap[recordID].last);
-        vector<int> *records = lastIndex.find(lastName);
+        Postings *records = lastIndex.find(lastName);
         if(records)
         {
             // Case if there are multiple records with the same last name already in the database
-            records->erase(remove(records->begin(), records->end(), recordID), records->end());
+            // (binary search in the sorted list, O(log p) amortized)
+            records->remove(recordID);
 
             // Case if removing the record also removes the last instance of that last name in the database
             if(records->empty()) {
@@ -82,75 +688,305 @@ struct Engine {
         }
     }
 
+    // Removes a set of record IDs from the postings list of a (lowercased)
+    // last name with one lookup of the list
+    void removePostings(const string &lastName, const vector<int> &recordIDs) {
+        Postings *records = lastIndex.find(lastName);
+        if(records)
+        {
+            for (int recordID : recordIDs) {
+                records->remove(recordID);
+            }
+
+            if(records->empty()) {
+                lastIndex.erase(lastName);
+            }
+        }
+    }
+
+    // Moves every row with ID in [lo, hi] into a new engine and returns it.
+    // Requires a split/join capable idIndex (TreapEngine): the ID range is cut
+    // out of idIndex in O(log n); only the k detached rows are then copied into
+    // the new heap segment (and unlinked from lastIndex), so the total cost is
+    // O(log n + k) instead of k separate idIndex erases.
+    // Not versioned: open read views simply stop seeing the detached rows.
+    // IDs whose current version is deleted but still indexed for those views
+    // are not moved; they are dropped here instead of by collectVersions(),
+    // and older versions of moved IDs are still collected there.
+    BasicEngine detachById(int lo, int hi) {
+        LogCommit durable(wal);
+        unique_lock<RWLatch> guard(latch);
+        uint64_t ts = ++clock;
+        BasicEngine out;
+        if (hi < lo) return out;
+
+        // 1. Carve [lo, hi] out of idIndex: rest | mid | right, then rejoin rest + right
+        IdIndex mid, right;
+        idIndex.splitAt(lo, mid);
+        if (hi < INT_MAX) mid.splitAt(hi + 1, right);
+        idIndex.join(right);
+
+        // 2. Copy the live rows into the new heap segment and remap the RIDs in place
+        vector<int> deadIds, deadRIDs;
+        mid.forEach([&](const int &id, IdEntry &entry) {
+            Record &row = heap[entry.recordID];
+            removePosting(toLower(row.last), entry.recordID);
+            if (heap.endTs(entry.recordID) != RecordHeap::kLive) {
+                deadIds.push_back(id);              // deleted, only kept for read views
+                deadRIDs.push_back(entry.recordID);
+                heap.retireRow(entry.recordID);
+                return;
+            }
+            int newID = out.heap.append(row);
+            out.addPosting(toLower(row.last), newID);
+
+            logDelete(durable, row.id);
+            heap.endVersion(entry.recordID, ts);
+            heap.retireRow(entry.recordID);
+            entry.recordID = newID;
+        });
+
+        // 3. Dropped versions leave the detached index and the collect queue,
+        //    so collectVersions() does not retire them a second time
+        for (int id : deadIds) mid.erase(id);
+        if (!deadRIDs.empty()) {
+            sort(deadRIDs.begin(), deadRIDs.end());
+            garbage.erase(remove_if(garbage.begin(), garbage.end(), [&](const DeadVersion &dead) {
+                return binary_search(deadRIDs.begin(), deadRIDs.end(), dead.recordID);
+            }), garbage.end());
+        }
+        liveRows -= mid.size();
+        out.liveRows = mid.size();
+
+        // 4. The detached index becomes the new engine's idIndex (join into empty is O(1))
+        out.idIndex.join(mid);
+        return out;
+    }
+
+    // Merges a previously detached engine back in, leaving `other` empty.
+    // The other engine's IDs must fall into a gap of this idIndex (no key of
+    // this engine between its smallest and largest ID); returns false and
+    // changes nothing otherwise. O(log n + k) like detachById.
+    bool attach(BasicEngine &other) {
+        LogCommit durable(wal);
+        scoped_lock guard(latch, other.latch);
+        if (other.idIndex.empty()) return true;
+        uint64_t ts = ++clock;
+        int lo = *other.idIndex.minKey(), hi = *other.idIndex.maxKey();
+
+        // 1. Open the gap at lo and make sure nothing of ours lies inside [lo, hi]
+        IdIndex right;
+        idIndex.splitAt(lo, right);
+        if (!right.empty() && *right.minKey() <= hi) {
+            idIndex.join(right);
+            return false;
+        }
+
+        // 2. Append the other engine's rows to our heap and remap the RIDs in place
+        other.idIndex.forEach([&](const int &, IdEntry &entry) {
+            int newID = heap.append(other.heap[entry.recordID], ts);
+            addPosting(toLower(heap[newID].last), newID);
+            logInsert(durable, heap[newID]);
+            entry.recordID = newID;
+        });
+        liveRows += other.idIndex.size();
+
+        // 3. Stitch the index back together: ours | other | right
+        idIndex.join(other.idIndex);
+        idIndex.join(right);
+
+        other.heap.clear();
+        other.lastIndex = BST<string, Postings>();
+        other.liveRows = 0;
+        return true;
+    }
+
     // Finds a record by student ID.
     // Returns a pointer to the record, or nullptr if not found.
     // Outputs the number of comparisons made in the search.
     const Record *findById(int id, int &cmpOut) {
-        // Zeroing out the comparisons value in idIndex
+        return findByIdAt(id, RecordHeap::kNow, cmpOut);
+    }
+
+    // findById as of commit timestamp S (see ReadView)
+    const Record *findByIdAt(int id, uint64_t S, int &cmpOut) {
+        QueryGuard guard(latch, IdIndex::selfAdjusting, IdIndex::concurrent);
+
+        // Zeroing out the comparisons value for this call
         cmpOut = 0;
-        idIndex.resetMetrics();
 
-        // Finding the record via the key 'id' inside idIndex
-        // Setting cmpOut to the number of comparisons tracked inside idIndex
-        int *idPtr = idIndex.find(id);
-        cmpOut = idIndex.comparisons;
+        // Finding the record via the key 'id' inside idIndex,
+        // counting the comparisons directly into cmpOut
+        auto idPtr = idIndex.find(id, cmpOut);
 
         // Case if the record doesn't exist inside idIndex
         if(!idPtr) {
             return nullptr;
         }
 
-        // Case if the record does exist but was soft-deleted in the heap
-        const Record &record = heap[*idPtr];
-        if(record.deleted) {
+        // Case if the record does exist but was soft-deleted (or inserted after S)
+        int recordID = indexedVersionAt(idPtr->recordID, S);
+        if(recordID < 0) {
             return nullptr;
         }
 
         // Otherwise, record has been found
-        return &record;
+        return &heap[recordID];
+
+    }
+
+    // Looks up many IDs at once (e.g. a class roster): result[i] is what
+    // findById(ids[i]) would return. Where idIndex has findMany (BST) the
+    // tree searches run interleaved with prefetching, and the heap rows of
+    // all hits are prefetched before any is read, so memory latency is
+    // overlapped across the batch. cmpOut is the total over all lookups.
+    vector<const Record *> findManyById(const int *ids, size_t n, int &cmpOut) {
+        QueryGuard guard(latch, IdIndex::selfAdjusting, IdIndex::concurrent);
+        cmpOut = 0;
+        vector<int> recordIDs(n, -1);
+
+        // 1. Resolving every ID to the RID of its newest version
+        if constexpr (HasFindMany<IdIndex>::value) {
+            vector<const IdEntry *> entries(n);
+            idIndex.findMany(ids, n, entries.data(), cmpOut);
+            for (size_t i = 0; i < n; ++i) {
+                if (entries[i]) recordIDs[i] = entries[i]->recordID;
+            }
+        } else {
+            for (size_t i = 0; i < n; ++i) {
+                auto entry = idIndex.find(ids[i], cmpOut);
+                if (entry) recordIDs[i] = entry->recordID;
+            }
+        }
 
+        // 2. Prefetching all the rows, then checking visibility and collecting them
+        for (int recordID : recordIDs) {
+            if (recordID >= 0) heap.prefetch(recordID);
+        }
+        vector<const Record *> found(n, nullptr);
+        for (size_t i = 0; i < n; ++i) {
+            int recordID = recordIDs[i] >= 0 ? indexedVersionAt(recordIDs[i], RecordHeap::kNow) : -1;
+            if (recordID >= 0) found[i] = &heap[recordID];
+        }
+        return found;
+    }
+    vector<const Record *> findManyById(const vector<int> &ids, int &cmpOut) {
+        return findManyById(ids.data(), ids.size(), cmpOut);
     }
 
     // Returns all records with ID in the range [lo, hi].
     // Also reports the number of key comparisons performed.
     vector<const Record *> rangeById(int lo, int hi, int &cmpOut) {
-        // Zeroing out the comparison values in idIndex
-        cmpOut = 0;
-        idIndex.resetMetrics();
+        return rangeByIdAt(lo, hi, RecordHeap::kNow, cmpOut);
+    }
 
+    // rangeById as of commit timestamp S (see ReadView)
+    vector<const Record *> rangeByIdAt(int lo, int hi, uint64_t S, int &cmpOut) {
         // Create a vector that will store the addresses of each record
         vector<const Record *> recordsInRange;
-        
-        // Using lambda function to add each node in the range IF the record hasn't been soft deleted
+        visitRangeByIdAt(lo, hi, S, [&](const Record &rec) { recordsInRange.push_back(&rec); }, cmpOut);
+        return recordsInRange;
+    }
+
+    // Calls fn(record) for every record with ID in [lo, hi] visible at S, in
+    // ID order, while holding the query latches (the walk behind rangeByIdAt)
+    template <typename Fn>
+    void visitRangeByIdAt(int lo, int hi, uint64_t S, Fn fn, int &cmpOut) {
+        QueryGuard guard(latch, IdIndex::selfAdjusting, IdIndex::concurrent);
+
+        // Zeroing out the comparisons value for this call
+        cmpOut = 0;
+
+        // Using lambda function to visit each node in the range IF the record hasn't been soft deleted
         idIndex.rangeApply(lo, hi, 
-            [&](const int &key, const int &recordID) {
-                if(recordID >= 0 && recordID < (int)heap.size() && !heap[recordID].deleted) {
-                    recordsInRange.push_back(&heap[recordID]);
+            [&](const int &, const IdEntry &entry) {
+                int recordID = entry.recordID;
+                if(recordID >= 0 && recordID < (int)heap.size()) {
+                    recordID = indexedVersionAt(recordID, S);
+                    if(recordID >= 0) {
+                        fn(heap[recordID]);
+                    }
                 }
-            }
+            },
+            cmpOut
         );
+    }
 
-        // Setting cmpOut to the number of comparisons tracked inside idIndex, and returning the records
-        cmpOut = idIndex.comparisons;
-        return recordsInRange;
+    // Counts records with ID in [lo, hi] in O(log n) using the subtree sizes
+    // of idIndex (no rows are visited). Like rankById/selectById/gpaStatsById
+    // it reads idIndex as is, so while read views are open it also counts
+    // deleted IDs that have not been collected yet.
+    // Also reports the number of key comparisons performed.
+    size_t countById(int lo, int hi, int &cmpOut) {
+        QueryGuard guard(latch, IdIndex::selfAdjusting, IdIndex::concurrent);
+        cmpOut = 0;
+        return idIndex.countRange(lo, hi, cmpOut);
+    }
+
+    // Number of live records with an ID smaller than `id` (its 0-based position by ID).
+    size_t rankById(int id, int &cmpOut) {
+        QueryGuard guard(latch, IdIndex::selfAdjusting, IdIndex::concurrent);
+        cmpOut = 0;
+        return idIndex.rank(id, cmpOut);
+    }
+
+    // Returns the i-th record in ID order (0-based), or nullptr if i is out of range.
+    const Record *selectById(size_t i, int &cmpOut) {
+        QueryGuard guard(latch, IdIndex::selfAdjusting, IdIndex::concurrent);
+        cmpOut = 0;
+        const IdEntry *entry = idIndex.select(i, cmpOut);
+        if (!entry) return nullptr;
+        int recordID = indexedVersionAt(entry->recordID, RecordHeap::kNow);
+        return recordID >= 0 ? &heap[recordID] : nullptr;
+    }
+
+    // COUNT/SUM/AVG/MIN/MAX of GPA over IDs in [lo, hi] in O(log n), read from
+    // the GpaSummary cached in idIndex (no heap rows are touched).
+    GpaSummary::value_type gpaStatsById(int lo, int hi, int &cmpOut) {
+        QueryGuard guard(latch, IdIndex::selfAdjusting, IdIndex::concurrent);
+        cmpOut = 0;
+        return idIndex.aggregateRange(lo, hi, cmpOut);
+    }
+
+    // Average GPA over IDs in [lo, hi] (0.0 if the range is empty).
+    double avgGpaById(int lo, int hi, int &cmpOut) {
+        return gpaStatsById(lo, hi, cmpOut).avg();
     }
 
     // Returns all records whose last name begins with a given prefix.
     // Case-insensitive using lowercase comparison.
     vector<const Record *> prefixByLast(const string &prefix, int &cmpOut) {
-        // Zeroing out the comparison values in lastIndex
-        cmpOut = 0;
-        lastIndex.resetMetrics();
+        return prefixByLastAt(prefix, RecordHeap::kNow, cmpOut);
+    }
 
-        // Turning the prefix lowercase and creating a vector to contain records with the prefix
+    // prefixByLast as of commit timestamp S (see ReadView). Postings hold
+    // every version that has not been collected, so each one is checked.
+    vector<const Record *> prefixByLastAt(const string &prefix, uint64_t S, int &cmpOut) {
+        // Creating a vector to contain records with the prefix
         vector<const Record *> recordsByLastName;
+        visitPrefixByLastAt(prefix, S, [&](const Record &rec) { recordsByLastName.push_back(&rec); }, cmpOut);
+        return recordsByLastName;
+    }
+
+    // Calls fn(record) for every record visible at S whose last name begins
+    // with prefix, by last name and then RID, while holding the query latches
+    // (the walk behind prefixByLastAt)
+    template <typename Fn>
+    void visitPrefixByLastAt(const string &prefix, uint64_t S, Fn fn, int &cmpOut) {
+        QueryGuard guard(latch, false, IdIndex::concurrent);
+        shared_lock<RWLatch> postings(lastLatch);
+
+        // Zeroing out the comparisons value for this call
+        cmpOut = 0;
+
+        // Turning the prefix lowercase
         string lowerPrefix = toLower(prefix);
 
         // Editing lambda function to go from a range of the prefix as the lower bound,
         // and the ~ character as the upper bound (has an ASCII value greater than any alphabet letter),
         // so that any last name greater than just the prefix will be included
         lastIndex.rangeApply(lowerPrefix, "~", 
-            [&](const string &key, const vector<int> &recordIDs) {
+            [&](const string &key, const Postings &recordIDs) {
                 
                 // Passes over the node if the lastName does not start with the given prefix
                 if(key.rfind(lowerPrefix, 0) != 0) {
@@ -160,19 +996,748 @@ struct Engine {
                 // Case if the node lastName contains the prefix at the beginning,
                 // mirroring the lambda function from rangeById, except this one captures
                 // every record in the list in case there are multiple records with the same last name
-                for (int recordID : recordIDs) {
-                    if(recordID >= 0 && recordID < (int)(heap.size() && !heap[recordID].deleted)) {
-                        recordsByLastName.push_back(&heap[recordID]);
+                recordIDs.forEach([&](int recordID) {
+                    if(recordID >= 0 && recordID < (int)heap.size() && heap.visibleAt(recordID, S)) {
+                        fn(heap[recordID]);
+                    }
+                });
+            },
+            cmpOut
+        );
+    }
+
+    // ================== Streaming Export ==================
+    // Writes query results into a record sink (CsvSink or ColumnarWriter, or
+    // any type with `bool add(const Record &)`) instead of first collecting a
+    // vector of pointers. The index is walked in passes of at most
+    // kExportBatch entries: a pass copies its visible rows under the query
+    // latches, releases them, and only then hands the rows to the sink, and
+    // the next pass resumes at the first key it did not take. Writers thus
+    // wait for one batch at most, never for sink I/O, and memory stays at one
+    // batch plus the sink's buffer however many rows match. Every pass reads
+    // at the same timestamp S, so the result is one consistent image: the
+    // plain overloads open a read view for the whole export, and the At
+    // overloads need the caller's view (or snapshot) at S to stay open. The
+    // caller finishes the sink (and checks it for I/O errors). Returns the
+    // number of records handed to the sink.
+    static constexpr size_t kExportBatch = 4096;   // index entries per latch hold
+
+    template <typename Sink>
+    size_t exportRangeById(int lo, int hi, Sink &sink) {
+        ReadView view(*this);
+        return exportRangeByIdAt(lo, hi, view.timestamp(), sink);
+    }
+    template <typename Sink>
+    size_t exportRangeByIdAt(int lo, int hi, uint64_t S, Sink &sink) {
+        size_t rows = 0;
+        vector<Record> batch;
+        for (int next = lo; next <= hi; ) {
+            // 1. Copying the rows of the next batch of IDs under the latches
+            size_t visited = 0;
+            bool more = false;
+            batch.clear();
+            {
+                QueryGuard guard(latch, IdIndex::selfAdjusting, IdIndex::concurrent);
+                int cmp = 0;
+                idIndex.rangeApply(next, hi, [&](const int &id, const IdEntry &entry) {
+                    if (visited++ == kExportBatch) {
+                        next = id;   // resume here
+                        more = true;
+                        return false;
+                    }
+                    int recordID = entry.recordID;
+                    if (recordID >= 0 && recordID < (int)heap.size()) {
+                        recordID = versionAt(recordID, S);
+                        if (recordID >= 0) batch.push_back(heap[recordID]);
+                    }
+                    return true;
+                }, cmp);
+            }
+
+            // 2. Writing them out with the latches released
+            for (const Record &rec : batch) sink.add(rec);
+            rows += batch.size();
+            if (!more) break;
+        }
+        return rows;
+    }
+    template <typename Sink>
+    size_t exportPrefixByLast(const string &prefix, Sink &sink) {
+        ReadView view(*this);
+        return exportPrefixByLastAt(prefix, view.timestamp(), sink);
+    }
+    template <typename Sink>
+    size_t exportPrefixByLastAt(const string &prefix, uint64_t S, Sink &sink) {
+        size_t rows = 0;
+        string lowerPrefix = toLower(prefix);
+        string fromKey = lowerPrefix;   // resume point: surname key and RID
+        int fromRID = 0;
+        vector<Record> batch;
+        for (;;) {
+            // 1. Copying the rows of the next batch of postings under the latches
+            size_t visited = 0;
+            bool more = false;
+            string nextKey;
+            int nextRID = 0;
+            batch.clear();
+            {
+                QueryGuard guard(latch, false, IdIndex::concurrent);
+                shared_lock<RWLatch> postings(lastLatch);
+                int cmp = 0;
+                lastIndex.rangeApply(fromKey, "~", [&](const string &key, const Postings &recordIDs) {
+                    if (key.rfind(lowerPrefix, 0) != 0) {
+                        return false;   // past the keys with the prefix
                     }
+                    recordIDs.forEachFrom(key == fromKey ? fromRID : 0, [&](int recordID) {
+                        if (visited++ == kExportBatch) {
+                            nextKey = key;   // resume here
+                            nextRID = recordID;
+                            more = true;
+                            return false;
+                        }
+                        if (recordID < (int)heap.size() && heap.visibleAt(recordID, S)) {
+                            batch.push_back(heap[recordID]);
+                        }
+                        return true;
+                    });
+                    return !more;
+                }, cmp);
+            }
+
+            // 2. Writing them out with the latches released
+            for (const Record &rec : batch) sink.add(rec);
+            rows += batch.size();
+            if (!more) break;
+            fromKey = std::move(nextKey);
+            fromRID = nextRID;
+        }
+        return rows;
+    }
+
+    // Frees heap chunks whose rows have all been deleted and returns the
+    // number of rows reclaimed. RIDs do not change, so no index is touched,
+    // and it runs alongside queries and writers (freed chunks go through the
+    // EpochDomain, see RecordHeap::compact). Versions that read views or
+    // snapshots may still reach are only retired by collectVersions(), so
+    // they are never freed here.
+    size_t compact() {
+        LatchGuard guard(latch, false);
+        return heap.compact();
+    }
+
+    // ================== Save / Load ==================
+    // Writes the current version of every live record to a binary snapshot
+    // file (see SnapshotFile), together with lastIndex in key order, so load()
+    // can rebuild both indexes from sorted input, and the position in the
+    // attached log it reflects (see Write-Ahead Logging). Blocks writers
+    // while the image is collected (not while it is written). Versions only
+    // open read views still see are not saved. Returns false on an I/O error.
+    bool save(const string &path) const {
+        SnapshotImage image;
+        {
+            LatchGuard guard(latch, IdIndex::concurrent);
+            shared_lock<RWLatch> postings(lastLatch);
+
+            // 1. Rows in ID order (idIndex order), remembering each RID's position
+            //    (the rows and lastIndex keys are interned in place: nothing
+            //    can change them while the latches are held)
+            vector<int> positionOf(heap.size(), -1);
+            image.reserve(liveRows);
+            forEachCurrent([&](int recordID, const Record &rec) {
+                positionOf[recordID] = (int)image.rows();
+                image.ids.push_back(rec.id);
+                image.gpas.push_back(rec.gpa);
+                image.lasts.push_back(image.intern(rec.last));
+                image.firsts.push_back(image.add(rec.first));   // nearly unique, not deduplicated
+                image.majors.push_back(image.intern(rec.major));
+            });
+
+            // 2. lastIndex keys with the positions of their live rows
+            vector<uint32_t> positions;
+            lastIndex.forEach([&](const string &lastName, const Postings &recordIDs) {
+                positions.clear();
+                recordIDs.forEach([&](int recordID) {
+                    if (positionOf[recordID] >= 0) positions.push_back((uint32_t)positionOf[recordID]);
+                });
+                if (positions.empty()) return;
+                sort(positions.begin(), positions.end());
+                image.keyNames.push_back(image.intern(lastName));
+                image.keyCounts.push_back((uint32_t)positions.size());
+                image.keyRows.insert(image.keyRows.end(), positions.begin(), positions.end());
+            });
+
+            // 3. The log position the image reflects (no writer runs now)
+            image.logPosition = wal ? wal->lastLsn() : logPosition;
+        }
+
+        // The log must be durable up to that position before a snapshot
+        // claims it, or a log reopened after a crash could reuse its LSNs
+        if (wal && !wal->commit(image.logPosition)) return false;
+        return SnapshotFile::write(path, image);
+    }
+
+    // ================== Checkpoints ==================
+    // save() for an engine too large to block writers while it is copied.
+    // checkpoint() opens a read view and notes the log position in the same
+    // step (no writer is in flight then, so the position covers exactly the
+    // writes up to the view's timestamp), then builds the image from the heap
+    // chunk by chunk without holding any latch: the view keeps every version
+    // it sees from being collected, and rows appended meanwhile begin after
+    // its timestamp. Writers keep running; while the view is open their
+    // updates and deletes only leave old versions behind (see Read Views).
+    // The file has save()'s format, so recovery is load() plus replay() of
+    // the log records after the checkpoint. Once the file is on disk the
+    // records it covers are dropped from the attached log (see
+    // WriteAheadLog::truncateThrough), so checkpointing regularly keeps the
+    // log, and recovery time, bounded; recovery then needs this checkpoint
+    // or a later one. May run on a background thread. Returns false on an
+    // I/O error (the log is left whole if the image could not be written).
+    bool checkpoint(const string &path) {
+        uint64_t S, position;
+        size_t heapLength;
+        {
+            LatchGuard guard(latch, IdIndex::concurrent);
+            S = registerView();
+            position = wal ? wal->lastLsn() : logPosition;
+            heapLength = heap.size();
+        }
+        bool ok = writeCheckpoint(path, S, heapLength, position);
+        closeView(S);
+        return ok && (!wal || wal->truncateThrough(position));
+    }
+
+    // Builds and writes the image of the versions visible at S among the
+    // first heapLength rows (caller holds a read view at S)
+    bool writeCheckpoint(const string &path, uint64_t S, size_t heapLength, uint64_t position) const {
+        SnapshotImage image;
+        image.logPosition = position;
+        {
+            // detachById retires rows without versioning, so a chunk may be
+            // compacted under the scan: the guard keeps it allocated until
+            // the strings the image interns in place are no longer needed
+            EpochGuard epoch;
+
+            // 1. The visible versions, chunk by chunk, then ordered by ID
+            vector<pair<int, int>> byId;   // (ID, RID)
+            byId.reserve(liveRows);
+            for (size_t start = 0; start < heapLength; start += RecordHeap::kChunkSize) {
+                if (!heap.resident(start)) continue;   // freed by compact(): every row was dead
+                size_t end = min(heapLength, start + RecordHeap::kChunkSize);
+                for (size_t recordID = start; recordID < end; ++recordID) {
+                    if (heap.visibleAt(recordID, S)) byId.push_back({heap[recordID].id, (int)recordID});
                 }
             }
-        );
+            sort(byId.begin(), byId.end());
 
-        // Setting cmpOut to the number of comparisons tracked inside idIndex, and returning the records
-        cmpOut = lastIndex.comparisons;
-        return recordsByLastName;
+            // 2. Rows in ID order, collecting each lowercased last name's
+            //    positions (ascending, since rows are visited in order)
+            unordered_map<string, vector<uint32_t>> positionsOf;
+            image.reserve(byId.size());
+            for (const auto &[id, recordID] : byId) {
+                const Record &rec = heap[recordID];
+                positionsOf[toLower(rec.last)].push_back((uint32_t)image.rows());
+                image.ids.push_back(id);
+                image.gpas.push_back(rec.gpa);
+                image.lasts.push_back(image.intern(rec.last));
+                image.firsts.push_back(image.add(rec.first));
+                image.majors.push_back(image.intern(rec.major));
+            }
+
+            // 3. lastIndex keys in key order
+            using KeyPositions = pair<const string, vector<uint32_t>>;
+            vector<const KeyPositions *> keys;
+            keys.reserve(positionsOf.size());
+            for (const KeyPositions &entry : positionsOf) keys.push_back(&entry);
+            sort(keys.begin(), keys.end(), [](const KeyPositions *a, const KeyPositions *b) { return a->first < b->first; });
+            for (const KeyPositions *key : keys) {
+                const vector<uint32_t> &positions = key->second;
+                image.keyNames.push_back(image.intern(key->first));
+                image.keyCounts.push_back((uint32_t)positions.size());
+                image.keyRows.insert(image.keyRows.end(), positions.begin(), positions.end());
+            }
+        }
+
+        // As in save(): the log must be durable up to the claimed position
+        if (wal && !wal->commit(position)) return false;
+        return SnapshotFile::write(path, image);
+    }
+
+    // ================== Bulk Import ==================
+    // Imports a registrar CSV/TSV export (id,last,first,major,gpa per line,
+    // see CsvImporter): the file is parsed by `threads` threads (0: one per
+    // hardware thread) and the rows go in as a single insertBatch, so
+    // idIndex is built or merged from sorted keys and each surname's
+    // postings list is looked up once, instead of one insertRecord per row.
+    // Like insertBatch, the first row with a given ID wins and IDs already
+    // in the engine are skipped. Fills `stats` (rows parsed, lines rejected,
+    // rows inserted); returns false if the file cannot be read.
+    bool importCsv(const string &path, CsvImportStats &stats, char delimiter = ',', unsigned threads = 0) {
+        vector<Record> rows;
+        if (!CsvImporter::readFile(path, rows, stats, delimiter, threads)) return false;
+        stats.inserted = insertBatch(rows);
+        return true;
+    }
+
+    // ================== Columnar Archive ==================
+    // Writes the current version of every live record, in ID order, to a
+    // ColumnarFile (blocks of blockRows rows with id/gpa zone maps and
+    // last/major dictionaries), streamed through exportRangeById: one
+    // consistent image, with writers waiting for a batch at a time, never
+    // for the file. Returns false on an I/O error.
+    bool saveColumnar(const string &path, uint32_t blockRows = ColumnarWriter::kDefaultBlockRows) {
+        ColumnarWriter writer(path, blockRows);
+        exportRangeById(INT_MIN, INT_MAX, writer);
+        return writer.finish();
+    }
+
+    // Scans a file written by saveColumnar without loading it: calls
+    // fn(const RecordView &) for every archived row matching pred, in ID
+    // order, skipping blocks by their zone maps and dictionaries (see
+    // ColumnarReader). The stats say how many blocks were skipped; `ok` is
+    // false if the file cannot be read.
+    template <typename Fn>
+    static ColumnarScanStats scanColumnar(const string &path, const ColumnarPredicate &pred, Fn fn) {
+        ColumnarReader reader;
+        if (!reader.open(path)) {
+            ColumnarScanStats failed;
+            failed.ok = false;
+            return failed;
+        }
+        return reader.scan(pred, fn);
+    }
+
+    // Exports the current version of every live record, in ID order, to a
+    // MappedRecordStore file: fixed-width slots plus a string blob that the
+    // store maps and reads in place, without loading or indexing anything.
+    // This is an export format, not a storage backend: the engine never
+    // reads the file back, so it is queried by opening a MappedRecordStore
+    // on it (and load() needs a save() snapshot). Blocks writers until the
+    // file is written. Returns false on an I/O error (or a string longer
+    // than a slot can describe).
+    bool exportMapped(const string &path) const {
+        LatchGuard guard(latch, IdIndex::concurrent);
+        MappedRecordStore::Writer writer(path);
+        bool ok = true;
+        forEachCurrent([&](int, const Record &rec) { ok = ok && writer.add(rec); });
+        return writer.finish() && ok;
+    }
+
+    // Loads a file written by save() into this engine, which must be empty.
+    // The rows go to the heap in ID order under one commit timestamp, idIndex
+    // is built from the sorted IDs (in one pass where it has insertSorted)
+    // and lastIndex from the saved postings, so nothing is re-sorted or
+    // re-lowercased. Returns false, leaving the engine untouched, if the
+    // file cannot be read, is not a valid snapshot, or the engine is not empty.
+    bool load(const string &path) {
+        SnapshotImage image;
+        if (!SnapshotFile::read(path, image)) return false;
+        LatchGuard guard(latch, true);
+        if (heap.size() != 0) return false;
+        uint64_t ts = ++clock;
+        size_t n = image.rows();
+
+        // 1. Appending the rows in heap-chunk sized batches (RIDs are then
+        //    0..n-1 in file order, since no writer can run meanwhile)
+        vector<Record> batch;
+        for (size_t start = 0; start < n; start += RecordHeap::kChunkSize) {
+            size_t end = min(n, start + RecordHeap::kChunkSize);
+            batch.resize(end - start);
+            for (size_t i = start; i < end; ++i) {
+                Record &rec = batch[i - start];
+                rec.id = image.ids[i];
+                rec.last = image.strings[image.lasts[i]];
+                rec.first = image.strings[image.firsts[i]];
+                rec.major = image.strings[image.majors[i]];
+                rec.gpa = image.gpas[i];
+            }
+            heap.appendBatch(batch.data(), batch.size(), ts);
+        }
+
+        // 2. Building idIndex from the ascending IDs
+        if constexpr (HasInsertSorted<IdIndex>::value) {
+            vector<pair<int, IdEntry>> items(n);
+            for (size_t i = 0; i < n; ++i) {
+                items[i] = {image.ids[i], IdEntry{(int)i, image.gpas[i]}};
+            }
+            vector<char> inserted;
+            idIndex.insertSorted(items, inserted);
+        } else {
+            for (size_t i = 0; i < n; ++i) {
+                idIndex.insert(image.ids[i], IdEntry{(int)i, image.gpas[i]});
+            }
+        }
+
+        // 3. Building lastIndex from the saved keys and postings (both sorted)
+        {
+            unique_lock<RWLatch> postings(lastLatch);
+            vector<pair<string, Postings>> lists(image.keyNames.size());
+            size_t at = 0;
+            for (size_t k = 0; k < lists.size(); ++k) {
+                lists[k].first = image.strings[image.keyNames[k]];
+                for (uint32_t j = 0; j < image.keyCounts[k]; ++j) {
+                    lists[k].second.add((int)image.keyRows[at++]);
+                }
+                lists[k].second.shrinkToFit();
+            }
+            vector<char> inserted;
+            lastIndex.insertSorted(lists, inserted);
+        }
+
+        liveRows = n;
+        logPosition = image.logPosition;
+        return true;
+    }
+
+    // ================== Write-Ahead Logging ==================
+    // With a log attached every successful insert, delete and update (also
+    // the batched ones, detachById and attach, row by row) appends a record
+    // while it still holds its latches and the ID's stripe (see lockId), so
+    // records of the same ID are logged in the order the writes took effect,
+    // and returns only once the record is durable (group commit, see
+    // LogCommit) or the log has failed. A failed write or fsync does not
+    // undo the change in memory, and the write method still reports it as
+    // done: writers that need durability check logFailed() after a write
+    // (or a batch of writes), as nothing logged from then on reaches the
+    // disk. Recovery after a crash:
+    // load() the last snapshot if there is one, replay() the log, then
+    // reopen the log with WriteAheadLog::open(path, logPosition) and attach
+    // it again. save() stores the log position it reflects, so replay skips
+    // what the snapshot already contains.
+
+    // Whether the attached log has failed, so writes since then (and the
+    // one that saw the failure) are not durable. Stays true until the log is
+    // reopened.
+    bool logFailed() const {
+        return wal && wal->hasFailed();
+    }
+
+    // Logs every later write to `log` (nullptr detaches). Must be called
+    // while no writer runs.
+    void attachLog(WriteAheadLog *log) {
+        unique_lock<RWLatch> guard(latch);
+        wal = log;
+    }
+
+    // Applies the records of the log at path that come after logPosition,
+    // through the ordinary insert/delete/update paths. Stops at a torn tail.
+    // Returns false if the log cannot be read, a record cannot be decoded,
+    // or a log is attached (the replayed writes would be logged again).
+    bool replay(const string &path) {
+        if (wal) return false;
+        bool decoded = true;
+        bool read = WriteAheadLog::replay(path, [&](uint64_t lsn, uint8_t kind, const char *payload, size_t n) {
+            if (!decoded || lsn <= logPosition) return;
+            LogRecordReader in(payload, n);
+            decoded = applyLogRecord(kind, in) && in.done();
+            if (decoded) logPosition = lsn;
+        });
+        return read && decoded;
+    }
+
+    // ----- Log record encoding (caller holds the latches of the write) -----
+    void logInsert(LogCommit &durable, const Record &rec) {
+        if (!wal) return;
+        LogRecordWriter &out = logScratch();
+        out.put((int32_t)rec.id);
+        out.putString(rec.last);
+        out.putString(rec.first);
+        out.putString(rec.major);
+        out.put(rec.gpa);
+        durable.lsn = wal->append(kLogInsert, out);
+    }
+    void logDelete(LogCommit &durable, int id) {
+        if (!wal) return;
+        LogRecordWriter &out = logScratch();
+        out.put((int32_t)id);
+        durable.lsn = wal->append(kLogDelete, out);
+    }
+    void logUpdate(LogCommit &durable, int id, const RecordPatch &patch) {
+        if (!wal) return;
+        LogRecordWriter &out = logScratch();
+        out.put((int32_t)id);
+        out.put(uint8_t((patch.last ? 1 : 0) | (patch.first ? 2 : 0) | (patch.major ? 4 : 0) | (patch.gpa ? 8 : 0)));
+        if (patch.last) out.putString(*patch.last);
+        if (patch.first) out.putString(*patch.first);
+        if (patch.major) out.putString(*patch.major);
+        if (patch.gpa) out.put(*patch.gpa);
+        durable.lsn = wal->append(kLogUpdate, out);
+    }
+
+    // Per-thread encode buffer, so logging a write allocates nothing
+    static LogRecordWriter &logScratch() {
+        thread_local LogRecordWriter scratch;
+        scratch.clear();
+        return scratch;
+    }
+
+    // Decodes one log record and applies it; false if it does not decode
+    bool applyLogRecord(uint8_t kind, LogRecordReader &in) {
+        int32_t id;
+        if (!in.get(id)) return false;
+        if (kind == kLogInsert) {
+            Record rec;
+            rec.id = id;
+            if (!in.getString(rec.last) || !in.getString(rec.first) || !in.getString(rec.major) || !in.get(rec.gpa))
+                return false;
+            insertRecord(rec);
+            return true;
+        }
+        if (kind == kLogDelete) {
+            deleteById(id);
+            return true;
+        }
+        if (kind == kLogUpdate) {
+            uint8_t mask;
+            RecordPatch patch;
+            string text;
+            double gpa;
+            if (!in.get(mask)) return false;
+            if (mask & 1) { if (!in.getString(text)) return false; patch.last = text; }
+            if (mask & 2) { if (!in.getString(text)) return false; patch.first = text; }
+            if (mask & 4) { if (!in.getString(text)) return false; patch.major = text; }
+            if (mask & 8) { if (!in.get(gpa)) return false; patch.gpa = gpa; }
+            updateById(id, patch);
+            return true;
+        }
+        return false;
+    }
+
+    // ================== Read Views (MVCC) ==================
+    // Consistent view of the engine as of the moment it was opened, for
+    // reports that must not see writes committed meanwhile. Every insert
+    // creates a row version beginning at its commit timestamp, every delete
+    // ends the current one, and a view at timestamp S sees exactly the
+    // versions with begin <= S < end (reinserting a deleted ID chains the new
+    // version to the old one, see reviveId).
+    // While any view is open, deletes leave the closed version in both
+    // indexes; closing a view runs collectVersions(), which drops whatever no
+    // remaining view can see. Each call on a view latches like the same call
+    // on the engine, so a long report interleaves with writers instead of
+    // blocking them. The engine must outlive its views.
+    class ReadView {
+        BasicEngine *engine;
+        uint64_t ts;          // read timestamp
+
+    public:
+        explicit ReadView(BasicEngine &engineIn) : engine(&engineIn), ts(engineIn.openView()) {}
+        ReadView(ReadView &&other) noexcept : engine(other.engine), ts(other.ts) {
+            other.engine = nullptr;
+        }
+        ReadView(const ReadView &) = delete;
+        ReadView &operator=(const ReadView &) = delete;
+        ~ReadView() {
+            if (engine) engine->closeView(ts);
+        }
 
+        uint64_t timestamp() const { return ts; }
+
+        // Same contracts as the engine's findById/rangeById/prefixByLast
+        const Record *findById(int id, int &cmpOut) const {
+            return engine->findByIdAt(id, ts, cmpOut);
+        }
+        vector<const Record *> rangeById(int lo, int hi, int &cmpOut) const {
+            return engine->rangeByIdAt(lo, hi, ts, cmpOut);
+        }
+        vector<const Record *> prefixByLast(const string &prefix, int &cmpOut) const {
+            return engine->prefixByLastAt(prefix, ts, cmpOut);
+        }
+    };
+
+    // Opens a read view at the latest commit (waits for in-flight writes).
+    ReadView beginRead() {
+        return ReadView(*this);
+    }
+
+    // Drops deleted versions that no open view can see any more and returns
+    // how many were dropped. Runs by itself whenever a view is closed.
+    size_t collectVersions() {
+        unique_lock<RWLatch> guard(latch);
+        return collectLocked();
+    }
+
+    // Registers a read view at the current commit timestamp. Holding the
+    // latch keeps writers out, so every timestamp <= S belongs to a finished write.
+    uint64_t openView() {
+        LatchGuard guard(latch, IdIndex::concurrent);
+        return registerView();
+    }
+    uint64_t registerView() {
+        lock_guard<mutex> lock(viewMutex);
+        uint64_t ts = clock.load();
+        viewTimestamps.insert(ts);
+        return ts;
+    }
+    void closeView(uint64_t ts) {
+        unique_lock<RWLatch> guard(latch);
+        {
+            lock_guard<mutex> lock(viewMutex);
+            viewTimestamps.erase(viewTimestamps.find(ts));
+        }
+        collectLocked();
+    }
+    bool viewsOpen() const {
+        lock_guard<mutex> lock(viewMutex);
+        return !viewTimestamps.empty();
+    }
+
+    // Unlinks every queued version that ended at or before the oldest open
+    // view from idIndex (or from the chain of the newer version that replaced
+    // it) and from lastIndex, and retires its row. A Snapshot's frozen idIndex
+    // may reach any of them, so nothing is collected while one is open.
+    // Caller holds `latch` exclusively.
+    size_t collectLocked() {
+        if (openSnapshots.load() != 0) return 0;
+        uint64_t oldest = RecordHeap::kNow;
+        {
+            lock_guard<mutex> lock(viewMutex);
+            if (!viewTimestamps.empty()) oldest = *viewTimestamps.begin();
+        }
+
+        unique_lock<RWLatch> postings(lastLatch);
+        size_t kept = 0, collected = 0;
+        for (const DeadVersion &dead : garbage) {
+            if (oldest < dead.endTs) {
+                garbage[kept++] = dead;
+                continue;
+            }
+            auto head = idIndex.find(dead.id);
+            int newer = head ? head->recordID : -1;
+            if (newer == dead.recordID) {
+                idIndex.erase(dead.id);
+            } else {
+                while (newer >= 0 && heap.prevVersion(newer) != dead.recordID) {
+                    newer = heap.prevVersion(newer);
+                }
+                if (newer >= 0) heap.setPrevVersion(newer, -1);
+            }
+            removePosting(toLower(heap[dead.recordID].last), dead.recordID);
+            heap.retireRow(dead.recordID);
+            ++collected;
+        }
+        garbage.resize(kept);
+        return collected;
+    }
+
+    // ================== Snapshots ==================
+    // Point-in-time view of the ID side of the engine, for long-running
+    // reports that must not see (or block) concurrent writes. Needs a
+    // persistent idIndex (PersistentEngine): taking a snapshot copies the
+    // idIndex root (O(1), later writes path-copy around the shared nodes)
+    // and opens a read view at the same commit timestamp; queries on it take
+    // no latch at all. The frozen idIndex may hold deleted IDs that read
+    // views still needed at the time: find/range skip them by timestamp,
+    // while countById/gpaStatsById include them.
+    // The rows it reaches are never rewritten while it is open (it counts
+    // as a read view, so updates write new versions). The engine must
+    // outlive its snapshots.
+    class Snapshot {
+        BasicEngine *engine;
+        IdIndex idIndex;      // frozen version of the engine's idIndex
+        size_t heapLength;    // heap rows that existed when the snapshot was taken
+        uint64_t ts;          // read timestamp
+
+    public:
+        Snapshot(BasicEngine &engineIn, const IdIndex &frozen, size_t length, uint64_t tsIn)
+            : engine(&engineIn), idIndex(frozen), heapLength(length), ts(tsIn) {}
+        Snapshot(Snapshot &&other) noexcept
+            : engine(other.engine), idIndex(std::move(other.idIndex)),
+              heapLength(other.heapLength), ts(other.ts) {
+            other.engine = nullptr;
+        }
+        Snapshot(const Snapshot &) = delete;
+        Snapshot &operator=(const Snapshot &) = delete;
+        ~Snapshot() {
+            if (!engine) return;
+            --engine->openSnapshots;
+            engine->closeView(ts);
+        }
+
+        size_t size() const { return idIndex.size(); }
+
+        // Same contracts as the engine's findById/rangeById/countById/gpaStatsById
+        const Record *findById(int id, int &cmpOut) const {
+            cmpOut = 0;
+            const IdEntry *entry = idIndex.find(id, cmpOut);
+            int recordID = entry ? engine->versionAt(entry->recordID, ts) : -1;
+            return recordID >= 0 ? &engine->heap[recordID] : nullptr;
+        }
+        vector<const Record *> rangeById(int lo, int hi, int &cmpOut) const {
+            cmpOut = 0;
+            vector<const Record *> recordsInRange;
+            idIndex.rangeApply(lo, hi,
+                [&](const int &, const IdEntry &entry) {
+                    if(entry.recordID >= 0 && entry.recordID < (int)heapLength) {
+                        int recordID = engine->versionAt(entry.recordID, ts);
+                        if(recordID >= 0) {
+                            recordsInRange.push_back(&engine->heap[recordID]);
+                        }
+                    }
+                },
+                cmpOut
+            );
+            return recordsInRange;
+        }
+        size_t countById(int lo, int hi, int &cmpOut) const {
+            cmpOut = 0;
+            return idIndex.countRange(lo, hi, cmpOut);
+        }
+        GpaSummary::value_type gpaStatsById(int lo, int hi, int &cmpOut) const {
+            cmpOut = 0;
+            return idIndex.aggregateRange(lo, hi, cmpOut);
+        }
+    };
+
+    // Takes a snapshot (O(1); waits only for an in-progress write to finish).
+    Snapshot snapshot() {
+        static_assert(IdIndex::persistent, "snapshot() needs a persistent idIndex (PersistentEngine)");
+        LatchGuard guard(latch, false);
+        ++openSnapshots;
+        return Snapshot(*this, idIndex, heap.size(), registerView());
+    }
+
+    // Collects row counts, index shape and the postings-length distribution.
+    // Not cheap: the shape figures come from a full walk of both indexes
+    // (O(#nodes), see BST::stats), and the latch is held for the whole walk,
+    // exclusively for a concurrent idIndex, so writers wait until it ends.
+    // Poll it at monitoring intervals, not per request; heap rows are not
+    // scanned.
+    EngineStats stats() const {
+        LatchGuard guard(latch, IdIndex::concurrent);
+        EngineStats st;
+        st.liveRows = liveRows;
+        st.tombstonedRows = heap.size() - liveRows;
+        st.reclaimedRows = heap.size() - heap.residentRows();
+        {
+            shared_lock<RWLatch> postings(lastLatch);
+            st.deadVersions = garbage.size();
+        }
+        st.idTree = idIndex.stats();
+        st.lastTree = lastIndex.stats();
+        st.distinctLastNames = lastIndex.size();
+
+        size_t totalPostings = 0;
+        lastIndex.forEach([&](const string &, const Postings &recordIDs) {
+            size_t len = recordIDs.size();
+            totalPostings += len;
+            st.postingsBytes += recordIDs.memoryBytes();
+            st.maxPostings = max(st.maxPostings, len);
+
+            // Bucket by floor(log2(len)) so a single huge surname stands out
+            size_t bucket = 0;
+            while ((len >> (bucket + 1)) != 0) ++bucket;
+            if (st.postingsLog2.size() <= bucket) st.postingsLog2.resize(bucket + 1, 0);
+            ++st.postingsLog2[bucket];
+        });
+        if (st.distinctLastNames) st.avgPostings = (double)totalPostings / st.distinctLastNames;
+        return st;
     }
 };
 
+using Engine = BasicEngine<>;                               // balanced (scapegoat) idIndex with GPA aggregates
+using SplayEngine = BasicEngine<SplayBST<int, IdEntry>>;    // self-adjusting idIndex for hot keys
+using TreapEngine = BasicEngine<Treap<int, IdEntry>>;       // splittable idIndex (detachById/attach)
+using ConcurrentEngine = BasicEngine<OLCBTree<int, IdEntry>>; // parallel inserts/deletes into idIndex
+using SkipListEngine = BasicEngine<SkipList<int, IdEntry>>;   // lock-free idIndex, epoch-reclaimed
+using PersistentEngine = BasicEngine<PersistentBST<int, IdEntry, GpaSummary>>; // O(1) snapshot()
+
 #endif
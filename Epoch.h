@@ -0,0 +1,196 @@
+#ifndef EPOCH_H
+#define EPOCH_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ================== Epoch-based reclamation ==================
+// Lets lock-free structures unlink a node while other threads may still be
+// reading it, and free it only once none of them can hold a pointer to it.
+//
+// Every thread that touches shared nodes does so inside an EpochGuard, which
+// announces the global epoch it entered in. A node that has been unlinked
+// (made unreachable for new readers) is retire()d, stamped with the epoch at
+// that moment. The global epoch only advances when every thread inside a
+// guard has announced the current one, so once it is two epochs past a
+// node's stamp, every reader that could have seen the node has left, and the
+// node is freed.
+//
+// There is one process-wide domain (like RCU). Threads register lazily on
+// their first guard and hand their unfreed retirements to the domain when
+// they exit.
+class EpochDomain {
+public:
+    static constexpr int kMaxThreads = 256; // concurrently registered threads
+
+    static EpochDomain &instance() {
+        static EpochDomain domain;
+        return domain;
+    }
+
+    // ----- Critical sections (use EpochGuard) -----
+    // Guards nest; only the outermost one announces and clears the epoch.
+    void enter() {
+        ThreadState &ts = local();
+        if (ts.nesting++ == 0)
+            slots[ts.slot].epoch.exchange(global.load()); // full barrier before the reads that follow
+    }
+    void exit() {
+        ThreadState &ts = local();
+        if (--ts.nesting == 0)
+            slots[ts.slot].epoch.store(kQuiescent, std::memory_order_release);
+    }
+
+    // ----- Retire -----
+    // p must already be unreachable for threads entering from now on.
+    // It is passed to deleter once no guard that might see it is left.
+    void retire(void *p, void (*deleter)(void *)) {
+        ThreadState &ts = local();
+        ts.retired.push_back({p, deleter, global.load()});
+        if (++ts.sinceScan >= kScanEvery) {
+            ts.sinceScan = 0;
+            tryAdvance();
+            collect(ts.retired);
+        }
+    }
+    template <typename T>
+    void retire(T *p) {
+        retire(p, [](void *q) { delete static_cast<T *>(q); });
+    }
+
+    // ----- Synchronize -----
+    // Waits until every guard active at the call has been left, then frees
+    // what this thread (and exited threads) retired so far. Must not be
+    // called from inside a guard.
+    void synchronize() {
+        std::uint64_t target = global.load() + 2;
+        while (global.load() < target) {
+            if (!tryAdvance()) std::this_thread::yield();
+        }
+        collect(local().retired);
+    }
+
+    // ----- Reclaim -----
+    // Non-blocking counterpart of synchronize(): advances the epoch as far
+    // as the active guards allow right now and frees what that makes safe.
+    // Bulk retirers call it so they need not wait for the kScanEvery-th
+    // retire. May be called from inside a guard.
+    void reclaim() {
+        if (tryAdvance()) tryAdvance();
+        collect(local().retired);
+    }
+
+    // Retirements of this thread and of exited threads not yet freed
+    std::size_t pending() {
+        std::lock_guard<std::mutex> lock(orphanMutex);
+        return local().retired.size() + orphans.size();
+    }
+
+    ~EpochDomain() {
+        for (Retired &r : orphans) r.deleter(r.p);
+    }
+
+private:
+    static constexpr std::uint64_t kQuiescent = 0; // slot value outside any guard
+    static constexpr unsigned kScanEvery = 64;     // retirements between reclaim attempts
+
+    struct Retired {
+        void *p;
+        void (*deleter)(void *);
+        std::uint64_t epoch;   // global epoch when retired
+    };
+
+    struct alignas(64) Slot {
+        std::atomic<std::uint64_t> epoch{kQuiescent};
+        std::atomic<bool> taken{false};
+    };
+
+    // Per-thread registration; unregisters when the thread exits
+    struct ThreadState {
+        int slot;
+        unsigned nesting = 0;
+        unsigned sinceScan = 0;
+        std::vector<Retired> retired;
+
+        ThreadState() : slot(instance().claimSlot()) {}
+        ~ThreadState() { instance().release(*this); }
+    };
+
+    std::atomic<std::uint64_t> global{1};
+    Slot slots[kMaxThreads];
+    std::mutex orphanMutex;
+    std::vector<Retired> orphans;   // left behind by exited threads
+
+    EpochDomain() = default;
+
+    static ThreadState &local() {
+        thread_local ThreadState ts;
+        return ts;
+    }
+
+    int claimSlot() {
+        for (;;) {
+            for (int i = 0; i < kMaxThreads; ++i) {
+                bool expected = false;
+                if (!slots[i].taken.load() && slots[i].taken.compare_exchange_strong(expected, true))
+                    return i;
+            }
+            std::this_thread::yield(); // more live threads than slots: wait for one to exit
+        }
+    }
+
+    void release(ThreadState &ts) {
+        {
+            std::lock_guard<std::mutex> lock(orphanMutex);
+            orphans.insert(orphans.end(), ts.retired.begin(), ts.retired.end());
+        }
+        ts.retired.clear();
+        slots[ts.slot].epoch.store(kQuiescent);
+        slots[ts.slot].taken.store(false);
+    }
+
+    // ----- Advance -----
+    // Moves the global epoch forward if every thread inside a guard has
+    // already announced the current one
+    bool tryAdvance() {
+        std::uint64_t e = global.load();
+        for (Slot &s : slots) {
+            std::uint64_t seen = s.epoch.load();
+            if (seen != kQuiescent && seen != e) return false;
+        }
+        return global.compare_exchange_strong(e, e + 1) || global.load() > e;
+    }
+
+    // ----- Collect -----
+    // Frees everything retired at least two epochs ago
+    void collect(std::vector<Retired> &list) {
+        std::uint64_t e = global.load();
+        auto freeOld = [e](std::vector<Retired> &v) {
+            std::size_t keep = 0;
+            for (Retired &r : v) {
+                if (r.epoch + 2 <= e) r.deleter(r.p);
+                else v[keep++] = r;
+            }
+            v.resize(keep);
+        };
+        freeOld(list);
+        std::lock_guard<std::mutex> lock(orphanMutex);
+        freeOld(orphans);
+    }
+};
+
+// Scoped epoch critical section: pointers read from an epoch-protected
+// structure stay valid until the guard is destroyed.
+class EpochGuard {
+public:
+    EpochGuard() { EpochDomain::instance().enter(); }
+    ~EpochGuard() { EpochDomain::instance().exit(); }
+    EpochGuard(const EpochGuard &) = delete;
+    EpochGuard &operator=(const EpochGuard &) = delete;
+};
+
+#endif
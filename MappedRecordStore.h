@@ -0,0 +1,281 @@
+#ifndef MAPPEDRECORDSTORE_H
+#define MAPPEDRECORDSTORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Record.h"
+
+// ================== Record View ==================
+// A record read in place from a MappedRecordStore: the strings point into
+// the mapping, so a view is valid while its store stays open.
+struct RecordView {
+    int id = 0;
+    std::string_view last;
+    std::string_view first;
+    std::string_view major;
+    double gpa = 0.0;
+
+    Record toRecord() const {
+        return Record{id, std::string(last), std::string(first), std::string(major), gpa, false};
+    }
+};
+
+// ================== Mapped Record Store ==================
+// Read-only reader for the mapped export format (see Engine::exportMapped):
+// a frozen copy of a table that other processes can open instantly and query
+// by ID without loading it, even when it is larger than RAM. It is not an
+// engine storage backend; nothing written to the engine after the export
+// reaches the file. The file holds one fixed-width 32-byte slot per record,
+// sorted by ID, and a blob with every record's last/first/major text back
+// to back:
+//   header   magic "BSTHEAP1", version, rows, blob offset/size, slot offset
+//   blob     last, first, major of each record, concatenated
+//   slots    per record: blob offset, gpa, id, the three string lengths
+// open() maps the file and checks the header, nothing more, so startup does
+// not depend on the size of the table; lookups binary-search the slots and
+// return RecordViews straight into the mapping, and the OS page cache
+// decides which pages stay resident.
+class MappedRecordStore {
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t reserved;
+        uint64_t rows;
+        uint64_t blobOffset;
+        uint64_t blobBytes;
+        uint64_t slotOffset;
+    };
+    struct Slot {
+        uint64_t text;       // blob offset of last, followed by first and major
+        double gpa;
+        int32_t id;
+        uint16_t lastLen;
+        uint16_t firstLen;
+        uint16_t majorLen;
+        uint16_t reserved;
+        uint32_t padding;
+    };
+    static_assert(sizeof(Slot) == 32, "slots are 32 bytes on disk");
+
+    static constexpr char kMagic[8] = {'B', 'S', 'T', 'H', 'E', 'A', 'P', '1'};
+    static constexpr uint32_t kVersion = 1;
+
+    const char *base = nullptr;   // start of the mapping
+    size_t length = 0;            // bytes mapped
+    const Slot *slots = nullptr;
+    const char *blob = nullptr;
+    size_t blobBytes = 0;
+    size_t rows = 0;
+
+public:
+    // ================== Writer ==================
+    // Streams a store file: records must be added in strictly ascending ID
+    // order. The blob is written as records arrive; only the slots (32 bytes
+    // per record) are buffered until finish().
+    class Writer {
+        std::FILE *f = nullptr;
+        std::vector<Slot> pending;
+        uint64_t blobBytes = 0;
+        bool ok = false;
+
+    public:
+        explicit Writer(const std::string &path) : f(std::fopen(path.c_str(), "wb")) {
+            Header h{};   // rewritten by finish()
+            ok = f && std::fwrite(&h, sizeof(h), 1, f) == 1;
+        }
+        ~Writer() {
+            if (f) std::fclose(f);
+        }
+        Writer(const Writer &) = delete;
+        Writer &operator=(const Writer &) = delete;
+
+        // Appends a record. Returns false (and fails the file) if its ID is
+        // not above the previous one, a string is longer than 65535 bytes,
+        // or the write fails.
+        bool add(const Record &rec) {
+            if (!ok) return false;
+            if (!pending.empty() && pending.back().id >= rec.id) return ok = false;
+            if (rec.last.size() > UINT16_MAX || rec.first.size() > UINT16_MAX || rec.major.size() > UINT16_MAX)
+                return ok = false;
+            Slot s{};
+            s.text = blobBytes;
+            s.gpa = rec.gpa;
+            s.id = rec.id;
+            s.lastLen = (uint16_t)rec.last.size();
+            s.firstLen = (uint16_t)rec.first.size();
+            s.majorLen = (uint16_t)rec.major.size();
+            for (const std::string *text : {&rec.last, &rec.first, &rec.major}) {
+                if (!text->empty() && std::fwrite(text->data(), 1, text->size(), f) != text->size())
+                    return ok = false;
+                blobBytes += text->size();
+            }
+            pending.push_back(s);
+            return true;
+        }
+
+        // Writes the slots and the header and closes the file. Returns false
+        // if any add() or write failed (the file is then incomplete).
+        bool finish() {
+            if (!f) return false;
+            // slots start 8-byte aligned after the blob
+            uint64_t slotOffset = (sizeof(Header) + blobBytes + 7) / 8 * 8;
+            static const char zeros[8] = {};
+            size_t pad = slotOffset - sizeof(Header) - blobBytes;
+            ok = ok && (pad == 0 || std::fwrite(zeros, 1, pad, f) == pad);
+            ok = ok && (pending.empty() || std::fwrite(pending.data(), sizeof(Slot), pending.size(), f) == pending.size());
+
+            Header h{};
+            std::memcpy(h.magic, kMagic, sizeof(kMagic));
+            h.version = kVersion;
+            h.rows = pending.size();
+            h.blobOffset = sizeof(Header);
+            h.blobBytes = blobBytes;
+            h.slotOffset = slotOffset;
+            ok = ok && std::fseek(f, 0, SEEK_SET) == 0 && std::fwrite(&h, sizeof(h), 1, f) == 1;
+            ok = std::fclose(f) == 0 && ok;
+            f = nullptr;
+            return ok;
+        }
+    };
+
+    MappedRecordStore() = default;
+    MappedRecordStore(const MappedRecordStore &) = delete;
+    MappedRecordStore &operator=(const MappedRecordStore &) = delete;
+    MappedRecordStore(MappedRecordStore &&other) noexcept { swapWith(other); }
+    MappedRecordStore &operator=(MappedRecordStore &&other) noexcept {
+        if (this != &other) {
+            close();
+            swapWith(other);
+        }
+        return *this;
+    }
+    ~MappedRecordStore() { close(); }
+
+    // ----- Open / Close -----
+    // Maps a store file read-only (closing any previous one). Returns false
+    // if it cannot be mapped or its header does not describe the file.
+    bool open(const std::string &path) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        bool ok = ::fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(Header);
+        void *mem = ok ? ::mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+        ::close(fd);   // the mapping keeps the file open
+        if (mem == MAP_FAILED) return false;
+        base = static_cast<const char *>(mem);
+        length = (size_t)st.st_size;
+
+        Header h;
+        std::memcpy(&h, base, sizeof(h));
+        bool valid = std::memcmp(h.magic, kMagic, sizeof(kMagic)) == 0 && h.version == kVersion &&
+                     h.blobOffset <= length && h.blobBytes <= length - h.blobOffset &&
+                     h.slotOffset % 8 == 0 && h.slotOffset <= length &&
+                     h.rows <= (length - h.slotOffset) / sizeof(Slot);
+        if (!valid) {
+            close();
+            return false;
+        }
+        rows = h.rows;
+        blob = base + h.blobOffset;
+        blobBytes = h.blobBytes;
+        slots = reinterpret_cast<const Slot *>(base + h.slotOffset);
+        return true;
+    }
+
+    void close() {
+        if (base) ::munmap(const_cast<char *>(base), length);
+        base = nullptr;
+        slots = nullptr;
+        blob = nullptr;
+        length = blobBytes = rows = 0;
+    }
+
+    bool isOpen() const { return base != nullptr; }
+    size_t size() const { return rows; }
+
+    // ----- Slot access -----
+    // The i-th record in ID order (i < size()). Text outside the blob (a
+    // corrupt slot) reads as empty strings.
+    RecordView operator[](size_t i) const {
+        const Slot &s = slots[i];
+        RecordView v;
+        v.id = s.id;
+        v.gpa = s.gpa;
+        uint64_t total = (uint64_t)s.lastLen + s.firstLen + s.majorLen;
+        if (s.text <= blobBytes && total <= blobBytes - s.text) {
+            const char *p = blob + s.text;
+            v.last = std::string_view(p, s.lastLen);
+            v.first = std::string_view(p + s.lastLen, s.firstLen);
+            v.major = std::string_view(p + s.lastLen + s.firstLen, s.majorLen);
+        }
+        return v;
+    }
+
+    // ----- Find -----
+    // Binary search over the slots; counts one comparison per probe plus
+    // the final equality check (only the probed slots' pages are touched)
+    std::optional<RecordView> findById(int id, int &cmpOut) const {
+        cmpOut = 0;
+        size_t i = lowerBound(id, cmpOut);
+        if (i == rows) return std::nullopt;
+        ++cmpOut;
+        if (slots[i].id != id) return std::nullopt;
+        return (*this)[i];
+    }
+
+    // ----- Range -----
+    // Records with IDs in [lo, hi], in ascending order
+    std::vector<RecordView> rangeById(int lo, int hi, int &cmpOut) const {
+        cmpOut = 0;
+        std::vector<RecordView> out;
+        for (size_t i = lowerBound(lo, cmpOut); i < rows; ++i) {
+            ++cmpOut;
+            if (slots[i].id > hi) break;
+            out.push_back((*this)[i]);
+        }
+        return out;
+    }
+
+    // ----- In-order Traversal -----
+    // Applies `fn(view)` to every record in ascending ID order
+    template <typename Fn>
+    void forEach(Fn fn) const {
+        for (size_t i = 0; i < rows; ++i) fn((*this)[i]);
+    }
+
+private:
+    // First slot whose ID is >= id
+    size_t lowerBound(int id, int &cmp) const {
+        size_t lo = 0, hi = rows;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            ++cmp;
+            if (slots[mid].id < id) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo;
+    }
+
+    void swapWith(MappedRecordStore &other) noexcept {
+        std::swap(base, other.base);
+        std::swap(length, other.length);
+        std::swap(slots, other.slots);
+        std::swap(blob, other.blob);
+        std::swap(blobBytes, other.blobBytes);
+        std::swap(rows, other.rows);
+    }
+};
+
+#endif
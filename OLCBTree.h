@@ -0,0 +1,487 @@
+#ifndef OLCBTREE_H
+#define OLCBTREE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "BST.h"
+
+// ================== Atomic Slot ==================
+// Holds a trivially copyable value as relaxed atomic 64-bit words, so a
+// reader may copy it while a writer overwrites it (the reader then fails
+// its version check and retries). This is what keeps optimistic readers
+// free of data races in the C++ memory model.
+template <typename T>
+class AtomicSlot {
+    static_assert(std::is_trivially_copyable<T>::value, "AtomicSlot needs a trivially copyable type");
+    static constexpr std::size_t kWords = (sizeof(T) + 7) / 8;
+    std::atomic<uint64_t> words[kWords];
+
+public:
+    AtomicSlot() {
+        for (auto &w : words) w.store(0, std::memory_order_relaxed);
+    }
+    T load() const {
+        uint64_t buf[kWords];
+        for (std::size_t i = 0; i < kWords; ++i) buf[i] = words[i].load(std::memory_order_relaxed);
+        T out;
+        std::memcpy(&out, buf, sizeof(T));
+        return out;
+    }
+    void store(const T &v) {
+        uint64_t buf[kWords] = {};
+        std::memcpy(buf, &v, sizeof(T));
+        for (std::size_t i = 0; i < kWords; ++i) words[i].store(buf[i], std::memory_order_relaxed);
+    }
+};
+
+// ================== Optimistic Lock Coupling B+tree ==================
+// Concurrent ordered index with the same interface as BST<K, V> (find,
+// insert, erase, rangeApply, forEach, size, stats), after Leis et al.,
+// "Optimistic Lock Coupling: A Scalable and Efficient General-Purpose
+// Synchronization Method".
+//
+// Every node carries a version word (bit 1 = write-locked, upper bits =
+// change counter). Readers never lock: they remember a node's version, read
+// it, and re-check the version before trusting what they read, restarting
+// from the root if a writer got in between. Writers descend the same way and
+// only lock the leaf they change (plus its parent when a node must split),
+// so inserts into different leaves proceed in parallel.
+//
+// Nodes are never freed while the tree is alive (erase removes keys from
+// leaves but does not merge nodes), so a reader can always safely follow a
+// pointer it read, even if it later has to restart.
+//
+// K, V - must be trivially copyable (they are stored in AtomicSlots)
+// Lookups return std::optional<V> copies, because a pointer into a leaf
+// could be overwritten by a concurrent insert at any moment.
+template <typename K, typename V>
+class OLCBTree {
+    static constexpr unsigned kLeafCap = 32;   // entries per leaf
+    static constexpr unsigned kInnerCap = 32;  // keys per inner node (children = keys + 1)
+
+    // ----- Node layouts -----
+    struct NodeBase {
+        std::atomic<uint64_t> version{0}; // bit 1: locked, bits 2+: counter
+        const bool isLeaf;
+        std::atomic<unsigned> count{0};   // keys stored
+        explicit NodeBase(bool leaf) : isLeaf(leaf) {}
+    };
+    struct Leaf : NodeBase {
+        AtomicSlot<K> keys[kLeafCap];
+        AtomicSlot<V> vals[kLeafCap];
+        std::atomic<Leaf *> next{nullptr}; // right sibling, for range scans
+        Leaf() : NodeBase(true) {}
+    };
+    // children[i] holds keys <= keys[i]; children[count] holds the rest
+    struct Inner : NodeBase {
+        AtomicSlot<K> keys[kInnerCap];
+        std::atomic<NodeBase *> children[kInnerCap + 1];
+        Inner() : NodeBase(false) {
+            for (auto &c : children) c.store(nullptr, std::memory_order_relaxed);
+        }
+    };
+
+    std::atomic<NodeBase *> root;
+    std::atomic<std::size_t> count{0};
+
+public:
+    static constexpr bool selfAdjusting = false; // lookups never modify the tree
+    static constexpr bool concurrent = true;     // insert/erase/find may run in parallel
+    static constexpr bool persistent = false;    // updates modify nodes in place
+
+    OLCBTree() : root(new Leaf()) {}
+    OLCBTree(const OLCBTree &) = delete;
+    OLCBTree &operator=(const OLCBTree &) = delete;
+
+    // ----- Destructor (no other thread may use the tree) -----
+    ~OLCBTree() { destroy(root.load()); }
+
+    // ----- Insert -----
+    // Returns true if inserted, false if the key already exists
+    bool insert(const K &k, const V &v) {
+        for (;;) {
+            int cmp = 0;
+            Inner *parent = nullptr;
+            uint64_t pv = 0, nv = 0;
+            NodeBase *node = root.load(std::memory_order_acquire);
+            if (!readLock(node, nv) || node != root.load(std::memory_order_acquire)) continue;
+
+            bool restart = false;
+            while (!node->isLeaf) {
+                Inner *inner = static_cast<Inner *>(node);
+                // Split full inner nodes on the way down so a child split
+                // always finds room in its parent
+                if (inner->count.load(std::memory_order_relaxed) == kInnerCap) {
+                    if (lockForSplit(parent, pv, inner, nv)) {
+                        K sep;
+                        Inner *right = splitInner(inner, sep);
+                        if (parent) insertChild(parent, sep, right);
+                        else makeRoot(inner, sep, right);
+                        writeUnlock(inner);
+                        if (parent) writeUnlock(parent);
+                    }
+                    restart = true;
+                    break;
+                }
+                if (parent && !validate(parent, pv)) { restart = true; break; }
+                NodeBase *child = inner->children[lowerBound(inner, k, cmp)].load(std::memory_order_acquire);
+                if (!child || !validate(inner, nv)) { restart = true; break; }
+                parent = inner;
+                pv = nv;
+                node = child;
+                // Re-check the parent once the child's version is taken: a
+                // split of the child in between would otherwise go unnoticed
+                // and k could land left of its new separator
+                if (!readLock(node, nv) || !validate(parent, pv)) { restart = true; break; }
+            }
+            if (restart) continue;
+
+            Leaf *leaf = static_cast<Leaf *>(node);
+            if (leaf->count.load(std::memory_order_relaxed) == kLeafCap) {
+                if (lockForSplit(parent, pv, leaf, nv)) {
+                    K sep;
+                    Leaf *right = splitLeaf(leaf, sep);
+                    if (parent) insertChild(parent, sep, right);
+                    else makeRoot(leaf, sep, right);
+                    writeUnlock(leaf);
+                    if (parent) writeUnlock(parent);
+                }
+                continue;
+            }
+
+            // A leaf's key range only changes when it splits, which bumps its
+            // version, so locking it at the version we read is enough
+            if (!upgrade(leaf, nv)) continue;
+            unsigned n = leaf->count.load(std::memory_order_relaxed);
+            unsigned pos = lowerBound(leaf, k, cmp);
+            if (pos < n && leaf->keys[pos].load() == k) {
+                writeUnlock(leaf);
+                return false; // duplicate key not allowed
+            }
+            for (unsigned i = n; i > pos; --i) {
+                leaf->keys[i].store(leaf->keys[i - 1].load());
+                leaf->vals[i].store(leaf->vals[i - 1].load());
+            }
+            leaf->keys[pos].store(k);
+            leaf->vals[pos].store(v);
+            leaf->count.store(n + 1, std::memory_order_relaxed);
+            writeUnlock(leaf);
+            ++count;
+            return true;
+        }
+    }
+
+    // ----- Find -----
+    // Returns a copy of the value stored under k, or nullopt
+    std::optional<V> find(const K &k) const {
+        int cmp = 0;
+        return find(k, cmp);
+    }
+    std::optional<V> find(const K &k, int &cmp) const {
+        for (;;) {
+            Leaf *leaf;
+            uint64_t v;
+            if (!descend(k, leaf, v, cmp)) continue;
+            unsigned n = leaf->count.load(std::memory_order_relaxed);
+            if (n > kLeafCap) n = kLeafCap; // torn read, validation below will fail
+            unsigned pos = lowerBound(leaf, k, cmp);
+            std::optional<V> out;
+            if (pos < n && leaf->keys[pos].load() == k) out = leaf->vals[pos].load();
+            if (validate(leaf, v)) return out;
+        }
+    }
+
+    // ----- Erase -----
+    // Removes k; if oldOut is given it receives the removed value. Checking
+    // and removing happen under one leaf lock, so of several threads erasing
+    // the same key exactly one succeeds.
+    bool erase(const K &k, V *oldOut = nullptr) {
+        for (;;) {
+            int cmp = 0;
+            Leaf *leaf;
+            uint64_t v;
+            if (!descend(k, leaf, v, cmp)) continue;
+            if (!upgrade(leaf, v)) continue;
+            unsigned n = leaf->count.load(std::memory_order_relaxed);
+            unsigned pos = lowerBound(leaf, k, cmp);
+            if (pos >= n || !(leaf->keys[pos].load() == k)) {
+                writeUnlock(leaf);
+                return false;
+            }
+            if (oldOut) *oldOut = leaf->vals[pos].load();
+            for (unsigned i = pos; i + 1 < n; ++i) {
+                leaf->keys[i].store(leaf->keys[i + 1].load());
+                leaf->vals[i].store(leaf->vals[i + 1].load());
+            }
+            leaf->count.store(n - 1, std::memory_order_relaxed);
+            writeUnlock(leaf);
+            --count;
+            return true;
+        }
+    }
+
+    // ----- Assign -----
+    // Replaces the value stored under k. Returns false if k is not present.
+    bool assign(const K &k, const V &v) {
+        for (;;) {
+            int cmp = 0;
+            Leaf *leaf;
+            uint64_t ver;
+            if (!descend(k, leaf, ver, cmp)) continue;
+            if (!upgrade(leaf, ver)) continue;
+            unsigned n = leaf->count.load(std::memory_order_relaxed);
+            unsigned pos = lowerBound(leaf, k, cmp);
+            bool found = pos < n && leaf->keys[pos].load() == k;
+            if (found) leaf->vals[pos].store(v);
+            writeUnlock(leaf);
+            return found;
+        }
+    }
+
+    // ----- Range Apply -----
+    // Applies `fn(key, value)` to all keys in [lo, hi] in ascending order
+    // (until fn returns false, see visitInRange). Each leaf is read
+    // consistently (copied, validated, then handed to fn), but the scan as a
+    // whole is not a snapshot: keys inserted concurrently into the part
+    // already passed are not seen.
+    template <typename Fn>
+    void rangeApply(const K &lo, const K &hi, Fn fn) const {
+        int cmp = 0;
+        rangeApply(lo, hi, fn, cmp);
+    }
+    template <typename Fn>
+    void rangeApply(const K &lo, const K &hi, Fn fn, int &cmp) const {
+        std::vector<std::pair<K, V>> buf;
+        bool haveLast = false;  // resume point after a failed validation
+        K last{};
+        for (;;) {
+            const K &start = haveLast ? last : lo;
+            Leaf *leaf;
+            uint64_t v;
+            if (!descend(start, leaf, v, cmp)) continue;
+
+            bool restart = false;
+            for (;;) {
+                buf.clear();
+                bool past = false;
+                unsigned n = leaf->count.load(std::memory_order_relaxed);
+                if (n > kLeafCap) n = kLeafCap;
+                for (unsigned i = 0; i < n; ++i) {
+                    K key = leaf->keys[i].load();
+                    ++cmp;
+                    if (hi < key) { past = true; break; }
+                    ++cmp;
+                    if (key < lo || (haveLast && !(last < key))) continue;
+                    buf.emplace_back(key, leaf->vals[i].load());
+                }
+                Leaf *next = leaf->next.load(std::memory_order_acquire);
+                if (!validate(leaf, v)) { restart = true; break; }
+
+                for (auto &kv : buf) {
+                    if (!visitInRange(fn, kv.first, kv.second)) return;
+                    last = kv.first;
+                    haveLast = true;
+                }
+                if (past || !next) return;
+                leaf = next;
+                if (!readLock(leaf, v)) { restart = true; break; }
+            }
+            if (!restart) return;
+        }
+    }
+
+    // ----- In-order Traversal (quiescent use only) -----
+    template <typename Fn>
+    void forEach(Fn fn) const {
+        NodeBase *n = root.load();
+        while (!n->isLeaf) n = static_cast<Inner *>(n)->children[0].load();
+        for (Leaf *leaf = static_cast<Leaf *>(n); leaf; leaf = leaf->next.load()) {
+            unsigned c = leaf->count.load();
+            for (unsigned i = 0; i < c; ++i) {
+                K key = leaf->keys[i].load();
+                V val = leaf->vals[i].load();
+                fn(key, val);
+            }
+        }
+    }
+
+    std::size_t size() const { return count.load(); }
+    bool empty() const { return size() == 0; }
+
+    // ----- Shape statistics (quiescent use only) -----
+    // For a B+tree every key sits at leaf level: levelFill counts tree nodes
+    // per level, nodes is the total node count and avgDepth = maxDepth.
+    TreeStats stats() const {
+        TreeStats st;
+        std::vector<const NodeBase *> level{root.load()};
+        while (!level.empty()) {
+            st.levelFill.push_back(level.size());
+            st.nodes += level.size();
+            std::vector<const NodeBase *> below;
+            for (const NodeBase *n : level) {
+                if (n->isLeaf) continue;
+                const Inner *in = static_cast<const Inner *>(n);
+                for (unsigned i = 0; i <= in->count.load(); ++i) below.push_back(in->children[i].load());
+            }
+            level.swap(below);
+        }
+        st.height = (int)st.levelFill.size();
+        st.maxDepth = st.height - 1;
+        st.avgDepth = st.maxDepth;
+        return st;
+    }
+
+private:
+    // ----- Version protocol -----
+    // Remember n's version for an optimistic read; fails if n is write-locked
+    static bool readLock(const NodeBase *n, uint64_t &v) {
+        v = n->version.load(std::memory_order_acquire);
+        if (v & 2) {
+            std::this_thread::yield();
+            return false;
+        }
+        return true;
+    }
+    // True if nothing was written to n since readLock returned v
+    static bool validate(const NodeBase *n, uint64_t v) {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return n->version.load(std::memory_order_relaxed) == v;
+    }
+    // Turn an optimistic read at version v into a write lock
+    static bool upgrade(NodeBase *n, uint64_t v) {
+        if (!n->version.compare_exchange_strong(v, v + 2, std::memory_order_acquire))
+            return false;
+        // keep the slot writes that follow from becoming visible before the lock
+        std::atomic_thread_fence(std::memory_order_release);
+        return true;
+    }
+    // Clears the lock bit and bumps the counter, publishing the writes
+    static void writeUnlock(NodeBase *n) {
+        n->version.fetch_add(2, std::memory_order_release);
+    }
+
+    // Locks a full node and its parent for a split. A node without parent
+    // must still be the root. Returns false (nothing locked) on conflict.
+    bool lockForSplit(Inner *parent, uint64_t pv, NodeBase *node, uint64_t nv) {
+        if (parent && !upgrade(parent, pv)) return false;
+        if (!upgrade(node, nv)) {
+            if (parent) writeUnlock(parent);
+            return false;
+        }
+        if (!parent && node != root.load(std::memory_order_acquire)) {
+            writeUnlock(node);
+            return false;
+        }
+        return true;
+    }
+
+    // ----- Optimistic descent -----
+    // Finds the leaf responsible for k and its version; false means restart
+    bool descend(const K &k, Leaf *&leaf, uint64_t &v, int &cmp) const {
+        NodeBase *node = root.load(std::memory_order_acquire);
+        if (!readLock(node, v) || node != root.load(std::memory_order_acquire)) return false;
+        while (!node->isLeaf) {
+            Inner *inner = static_cast<Inner *>(node);
+            NodeBase *child = inner->children[lowerBound(inner, k, cmp)].load(std::memory_order_acquire);
+            if (!validate(inner, v)) return false;
+            uint64_t cv;
+            if (!child || !readLock(child, cv)) return false;
+            if (!validate(inner, v)) return false;
+            node = child;
+            v = cv;
+        }
+        leaf = static_cast<Leaf *>(node);
+        return true;
+    }
+
+    // ----- Binary search: first slot whose key is >= k -----
+    template <typename N>
+    static unsigned lowerBound(const N *n, const K &k, int &cmp) {
+        unsigned lo = 0, hi = n->count.load(std::memory_order_relaxed);
+        unsigned cap = sizeof(n->keys) / sizeof(n->keys[0]);
+        if (hi > cap) hi = cap; // torn read, caller's validation will fail
+        while (lo < hi) {
+            unsigned mid = (lo + hi) / 2;
+            ++cmp;
+            if (n->keys[mid].load() < k) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo;
+    }
+
+    // ----- Splits (caller holds the node's write lock) -----
+    // Moves the upper half into a new right sibling; sep = largest key left behind
+    static Leaf *splitLeaf(Leaf *leaf, K &sep) {
+        Leaf *right = new Leaf();
+        unsigned n = leaf->count.load(std::memory_order_relaxed);
+        unsigned keep = n - n / 2;
+        for (unsigned i = keep; i < n; ++i) {
+            right->keys[i - keep].store(leaf->keys[i].load());
+            right->vals[i - keep].store(leaf->vals[i].load());
+        }
+        right->count.store(n - keep, std::memory_order_relaxed);
+        right->next.store(leaf->next.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        leaf->count.store(keep, std::memory_order_relaxed);
+        leaf->next.store(right, std::memory_order_release);
+        sep = leaf->keys[keep - 1].load();
+        return right;
+    }
+    // Keys after the middle go right; the middle key moves up as sep
+    static Inner *splitInner(Inner *inner, K &sep) {
+        Inner *right = new Inner();
+        unsigned n = inner->count.load(std::memory_order_relaxed);
+        unsigned mid = n / 2;
+        for (unsigned i = mid + 1; i < n; ++i) right->keys[i - mid - 1].store(inner->keys[i].load());
+        for (unsigned i = mid + 1; i <= n; ++i)
+            right->children[i - mid - 1].store(inner->children[i].load(std::memory_order_relaxed),
+                                               std::memory_order_relaxed);
+        right->count.store(n - mid - 1, std::memory_order_relaxed);
+        sep = inner->keys[mid].load();
+        inner->count.store(mid, std::memory_order_relaxed);
+        return right;
+    }
+    // Adds (sep, right) to a locked parent that has room; the old child stays left of sep
+    static void insertChild(Inner *parent, const K &sep, NodeBase *right) {
+        int cmp = 0;
+        unsigned n = parent->count.load(std::memory_order_relaxed);
+        unsigned pos = lowerBound(parent, sep, cmp);
+        for (unsigned i = n; i > pos; --i) {
+            parent->keys[i].store(parent->keys[i - 1].load());
+            parent->children[i + 1].store(parent->children[i].load(std::memory_order_relaxed),
+                                          std::memory_order_relaxed);
+        }
+        parent->keys[pos].store(sep);
+        parent->children[pos + 1].store(right, std::memory_order_release);
+        parent->count.store(n + 1, std::memory_order_relaxed);
+    }
+    // Grows the tree by one level above a split root
+    void makeRoot(NodeBase *left, const K &sep, NodeBase *right) {
+        Inner *r = new Inner();
+        r->keys[0].store(sep);
+        r->children[0].store(left, std::memory_order_relaxed);
+        r->children[1].store(right, std::memory_order_relaxed);
+        r->count.store(1, std::memory_order_relaxed);
+        root.store(r, std::memory_order_release);
+    }
+
+    // ----- Free every node (postorder) -----
+    static void destroy(NodeBase *n) {
+        if (!n) return;
+        if (n->isLeaf) {
+            delete static_cast<Leaf *>(n);
+            return;
+        }
+        Inner *in = static_cast<Inner *>(n);
+        for (unsigned i = 0; i <= in->count.load(); ++i) destroy(in->children[i].load());
+        delete in;
+    }
+};
+
+#endif
@@ -0,0 +1,397 @@
+#ifndef PERSISTENTBST_H
+#define PERSISTENTBST_H
+
+#include <climits>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "BST.h"
+
+// ================== Persistent (path-copying) BST ==================
+// Copy-on-write variant of BST<K, V, Summary> with the same interface and
+// the same scapegoat balancing, subtree sizes and Summaries.
+//
+// Nodes are immutable once built and shared through reference counts.
+// insert/erase never modify a node: they copy the O(log n) nodes on the
+// search path and point the copies at the untouched subtrees. Copying a
+// PersistentBST therefore costs O(1) and yields a frozen version that later
+// updates of the original cannot change; both versions share every subtree
+// neither has modified. A scapegoat rebuild copies the rebuilt subtree.
+//
+// Each version is an ordinary single-writer object. Different versions can
+// be read and updated from different threads without locking, since shared
+// nodes are never written (reference counts are atomic).
+//
+// find/select return pointers into this version's nodes; they stay valid
+// until this version is next updated or destroyed.
+template <typename K, typename V, typename Summary = NoSummary>
+class PersistentBST {
+public:
+    using summary_type = typename Summary::value_type;
+
+private:
+    // ----- Internal Node structure (immutable) -----
+    struct Node;
+    using NodePtr = std::shared_ptr<const Node>;
+
+    struct Node {
+        K key;            // key used for ordering
+        V val;            // associated value (payload)
+        NodePtr left;     // left subtree (keys smaller than this node)
+        NodePtr right;    // right subtree (keys larger than this node)
+        std::size_t size; // number of nodes in this subtree (including itself)
+        summary_type agg; // Summary of this subtree
+
+        Node(const K &k, const V &v, NodePtr l, NodePtr r)
+            : key(k), val(v), left(std::move(l)), right(std::move(r)),
+              size(1 + sz(left) + sz(right)) {
+            summary_type a = left ? left->agg : Summary::identity();
+            a = Summary::combine(a, Summary::lift(key, val));
+            agg = right ? Summary::combine(a, right->agg) : a;
+        }
+    };
+
+    NodePtr root;               // root of this version
+    std::size_t count = 0;      // number of nodes in this version
+    std::size_t maxCount = 0;   // largest count since the last full rebuild
+    double alpha = 0.75;        // scapegoat weight-balance factor, 1.0 disables rebuilding
+    std::size_t rebuildCount = 0; // number of subtree rebuilds performed
+
+public:
+    static constexpr bool selfAdjusting = false; // lookups never modify the tree
+    static constexpr bool concurrent = false;    // callers must serialize writers of one version
+    static constexpr bool persistent = true;     // copies are O(1) frozen versions
+
+    int comparisons = 0;   // counts number of comparisons made (for performance analysis)
+
+    PersistentBST() = default;
+
+    // ----- Versions -----
+    // Copying shares the root: O(1), and the copy never sees later updates
+    PersistentBST(const PersistentBST &) = default;
+    PersistentBST &operator=(const PersistentBST &) = default;
+    PersistentBST(PersistentBST &&) noexcept = default;
+    PersistentBST &operator=(PersistentBST &&) noexcept = default;
+
+    // ----- Insert -----
+    // Returns true if inserted successfully, false if key already exists
+    bool insert(const K &k, const V &v) {
+        InsertState st;
+        NodePtr r = insertRec(root, k, v, 0, st);
+        if (!st.inserted) return false;
+        root = std::move(r);
+        if (++count > maxCount) maxCount = count;
+        return true;
+    }
+
+    // ----- Find -----
+    // Returns a pointer to the value associated with the key, or nullptr
+    const V *find(const K &k) {
+        return find(k, comparisons);
+    }
+    const V *find(const K &k, int &cmp) const {
+        const Node *n = root.get();
+        while (n) {
+            ++cmp;
+            if (k == n->key) return &n->val;
+            ++cmp;
+            n = k < n->key ? n->left.get() : n->right.get();
+        }
+        return nullptr;
+    }
+
+    // ----- Assign -----
+    // Replaces the value stored under k (copying its path).
+    // Returns false if k is not in the tree.
+    bool assign(const K &k, const V &v) {
+        bool found = false;
+        NodePtr r = assignRec(root, k, v, found);
+        if (found) root = std::move(r);
+        return found;
+    }
+
+    // ----- Erase -----
+    // Returns true if a node was deleted, false otherwise
+    // (if oldOut is given it receives the removed value)
+    bool erase(const K &k, V *oldOut = nullptr) {
+        bool erased = false;
+        NodePtr r = eraseRec(root, k, erased, oldOut);
+        if (!erased) return false;
+        root = std::move(r);
+        --count;
+        if (alpha < 1.0 && count < alpha * maxCount) {
+            root = rebuild(root, count);
+            maxCount = count;
+        }
+        return true;
+    }
+
+    // ----- Range Apply -----
+    // Applies `fn(key, value)` to all nodes with keys in [lo, hi] (until fn
+    // returns false, see visitInRange)
+    template <typename Fn>
+    void rangeApply(const K &lo, const K &hi, Fn fn) {
+        rangeRec(root.get(), lo, hi, fn, comparisons);
+    }
+    template <typename Fn>
+    void rangeApply(const K &lo, const K &hi, Fn fn, int &cmp) const {
+        rangeRec(root.get(), lo, hi, fn, cmp);
+    }
+
+    // ----- In-order Traversal -----
+    template <typename Fn>
+    void forEach(Fn fn) const {
+        forEachRec(root.get(), fn);
+    }
+
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    // ----- Shape statistics (same meaning as BST::stats) -----
+    TreeStats stats() const {
+        TreeStats st;
+        double depthSum = 0;
+        statsRec(root.get(), 0, st, depthSum);
+        st.height = (int)st.levelFill.size();
+        st.maxDepth = st.height - 1;
+        if (st.nodes) st.avgDepth = depthSum / st.nodes;
+        return st;
+    }
+
+    // ----- Order statistics (all O(log n)) -----
+    std::size_t rank(const K &k) {
+        return rankRec(root.get(), k, false, comparisons);
+    }
+    std::size_t rank(const K &k, int &cmp) const {
+        return rankRec(root.get(), k, false, cmp);
+    }
+    const V *select(std::size_t i) {
+        return select(i, comparisons);
+    }
+    const V *select(std::size_t i, int &cmp) const {
+        const Node *n = root.get();
+        while (n) {
+            ++cmp;
+            std::size_t leftSize = sz(n->left);
+            if (i < leftSize) {
+                n = n->left.get();
+            } else if (i == leftSize) {
+                return &n->val;
+            } else {
+                i -= leftSize + 1;
+                n = n->right.get();
+            }
+        }
+        return nullptr;
+    }
+    std::size_t countRange(const K &lo, const K &hi) {
+        return countRange(lo, hi, comparisons);
+    }
+    std::size_t countRange(const K &lo, const K &hi, int &cmp) const {
+        if (hi < lo) return 0;
+        return rankRec(root.get(), hi, true, cmp) - rankRec(root.get(), lo, false, cmp);
+    }
+
+    // ----- Range aggregate (same as BST::aggregateRange) -----
+    summary_type aggregateRange(const K &lo, const K &hi) {
+        return aggregateRange(lo, hi, comparisons);
+    }
+    summary_type aggregateRange(const K &lo, const K &hi, int &cmp) const {
+        if (hi < lo) return Summary::identity();
+        return aggregateRec(root.get(), lo, hi, false, false, cmp);
+    }
+    summary_type aggregate() const {
+        return root ? root->agg : Summary::identity();
+    }
+
+    // ----- Rebalancing control (same as BST) -----
+    void setBalanceFactor(double a) {
+        alpha = a < 0.5 ? 0.5 : (a > 1.0 ? 1.0 : a);
+        maxCount = count;
+    }
+    double balanceFactor() const { return alpha; }
+    std::size_t rebuilds() const { return rebuildCount; }
+
+    // ----- Resets the comparison counter -----
+    void resetMetrics() { comparisons = 0; }
+
+private:
+    static std::size_t sz(const NodePtr &n) { return n ? n->size : 0; }
+
+    static NodePtr make(const K &k, const V &v, NodePtr l, NodePtr r) {
+        return std::make_shared<const Node>(k, v, std::move(l), std::move(r));
+    }
+
+    // ----- Insert bookkeeping (as in BST) -----
+    struct InsertState {
+        bool inserted = false; // a new node was created
+        bool tooDeep = false;  // it landed below the depth limit and no scapegoat was rebuilt yet
+    };
+
+    int depthLimit(std::size_t n) const {
+        if (alpha >= 1.0 || n < 2) return INT_MAX;
+        return (int)std::floor(std::log((double)n) / std::log(1.0 / alpha));
+    }
+
+    // ----- Recursive Insert (path copying) -----
+    // Returns the new version of subtree n, or n itself if k was already there
+    NodePtr insertRec(const NodePtr &n, const K &k, const V &v, int depth, InsertState &st) {
+        if (!n) {
+            st.inserted = true;
+            st.tooDeep = depth > depthLimit(count + 1);
+            return make(k, v, nullptr, nullptr);
+        }
+        ++comparisons;
+        if (k == n->key)
+            return n; // duplicate key not allowed
+        ++comparisons;
+        bool goLeft = k < n->key;
+        NodePtr child = insertRec(goLeft ? n->left : n->right, k, v, depth + 1, st);
+        if (!st.inserted)
+            return n;
+        NodePtr copy = goLeft ? make(n->key, n->val, child, n->right)
+                              : make(n->key, n->val, n->left, child);
+
+        // Unwinding a too-deep insert: rebuild the first alpha-unbalanced ancestor
+        if (st.tooDeep && sz(child) > alpha * copy->size) {
+            st.tooDeep = false;
+            return rebuild(copy, copy->size);
+        }
+        return copy;
+    }
+
+    // ----- Recursive Assign (path copying) -----
+    NodePtr assignRec(const NodePtr &n, const K &k, const V &v, bool &found) {
+        if (!n) return n;
+        ++comparisons;
+        if (k == n->key) {
+            found = true;
+            return make(k, v, n->left, n->right);
+        }
+        ++comparisons;
+        if (k < n->key) {
+            NodePtr l = assignRec(n->left, k, v, found);
+            return found ? make(n->key, n->val, l, n->right) : n;
+        }
+        NodePtr r = assignRec(n->right, k, v, found);
+        return found ? make(n->key, n->val, n->left, r) : n;
+    }
+
+    // ----- Recursive Erase (path copying) -----
+    NodePtr eraseRec(const NodePtr &n, const K &k, bool &erased, V *oldOut) {
+        if (!n) return nullptr;
+        ++comparisons;
+        if (k < n->key) {
+            NodePtr l = eraseRec(n->left, k, erased, oldOut);
+            return erased ? make(n->key, n->val, l, n->right) : n;
+        }
+        if (n->key < k) {
+            NodePtr r = eraseRec(n->right, k, erased, oldOut);
+            return erased ? make(n->key, n->val, n->left, r) : n;
+        }
+        erased = true;
+        if (oldOut) *oldOut = n->val;
+        if (!n->left) return n->right;
+        if (!n->right) return n->left;
+        // two children: the inorder successor takes this node's place
+        const Node *succ = n->right.get();
+        while (succ->left) succ = succ->left.get();
+        bool dummy = false;
+        return make(succ->key, succ->val, n->left, eraseRec(n->right, succ->key, dummy, nullptr));
+    }
+
+    // ----- Rebuild -----
+    // Builds a perfectly balanced copy of subtree n (the old nodes stay
+    // untouched for any version still sharing them)
+    NodePtr rebuild(const NodePtr &n, std::size_t size) {
+        ++rebuildCount;
+        std::vector<const Node *> nodes;
+        nodes.reserve(size);
+        flatten(n.get(), nodes);
+        return buildBalanced(nodes, 0, nodes.size());
+    }
+    static void flatten(const Node *n, std::vector<const Node *> &out) {
+        if (!n) return;
+        flatten(n->left.get(), out);
+        out.push_back(n);
+        flatten(n->right.get(), out);
+    }
+    static NodePtr buildBalanced(const std::vector<const Node *> &nodes, std::size_t lo, std::size_t hi) {
+        if (lo >= hi) return nullptr;
+        std::size_t mid = lo + (hi - lo) / 2;
+        NodePtr l = buildBalanced(nodes, lo, mid);
+        NodePtr r = buildBalanced(nodes, mid + 1, hi);
+        return make(nodes[mid]->key, nodes[mid]->val, std::move(l), std::move(r));
+    }
+
+    // ----- Recursive Rank -----
+    static std::size_t rankRec(const Node *n, const K &k, bool inclusive, int &cmp) {
+        if (!n) return 0;
+        ++cmp;
+        bool goRight = inclusive ? !(k < n->key) : n->key < k;
+        if (goRight)
+            return sz(n->left) + 1 + rankRec(n->right.get(), k, inclusive, cmp);
+        return rankRec(n->left.get(), k, inclusive, cmp);
+    }
+
+    // ----- Recursive Range Aggregate (see BST::aggregateRec) -----
+    static summary_type aggregateRec(const Node *n, const K &lo, const K &hi,
+                                     bool loOpen, bool hiOpen, int &cmp) {
+        if (!n) return Summary::identity();
+        if (loOpen && hiOpen) return n->agg;
+
+        if (!loOpen) {
+            ++cmp;
+            if (n->key < lo) return aggregateRec(n->right.get(), lo, hi, loOpen, hiOpen, cmp);
+        }
+        if (!hiOpen) {
+            ++cmp;
+            if (hi < n->key) return aggregateRec(n->left.get(), lo, hi, loOpen, hiOpen, cmp);
+        }
+        summary_type a = aggregateRec(n->left.get(), lo, hi, loOpen, true, cmp);
+        a = Summary::combine(a, Summary::lift(n->key, n->val));
+        return Summary::combine(a, aggregateRec(n->right.get(), lo, hi, true, hiOpen, cmp));
+    }
+
+    // ----- Recursive Range Traversal -----
+    template <typename Fn>
+    static bool rangeRec(const Node *n, const K &lo, const K &hi, Fn &fn, int &cmp) {
+        if (!n) return true;
+
+        ++cmp;
+        if (lo < n->key && !rangeRec(n->left.get(), lo, hi, fn, cmp))
+            return false;                              // explore left if possible
+
+        ++cmp;
+        if (!(n->key < lo) && !(hi < n->key) && !visitInRange(fn, n->key, n->val))
+            return false;                              // apply function in range
+
+        ++cmp;
+        if (n->key < hi)
+            return rangeRec(n->right.get(), lo, hi, fn, cmp); // explore right if possible
+        return true;
+    }
+
+    // ----- Helper: In-order Traversal -----
+    template <typename Fn>
+    static void forEachRec(const Node *n, Fn &fn) {
+        if (!n) return;
+        forEachRec(n->left.get(), fn);
+        fn(n->key, n->val);
+        forEachRec(n->right.get(), fn);
+    }
+
+    // ----- Helper: Shape Statistics -----
+    static void statsRec(const Node *n, int depth, TreeStats &st, double &depthSum) {
+        if (!n) return;
+        if ((int)st.levelFill.size() <= depth) st.levelFill.resize(depth + 1, 0);
+        ++st.levelFill[depth];
+        ++st.nodes;
+        depthSum += depth;
+        statsRec(n->left.get(), depth + 1, st, depthSum);
+        statsRec(n->right.get(), depth + 1, st, depthSum);
+    }
+};
+
+#endif
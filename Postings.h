@@ -0,0 +1,220 @@
+#ifndef POSTINGS_H
+#define POSTINGS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+// ================== Postings List ==================
+// The record IDs (RIDs) stored under one lastIndex key, kept sorted and
+// compressed. RIDs are cut into blocks of up to kBlockSize; a block stores
+// its first RID in a small directory and every following RID as the delta
+// to its predecessor in variable-byte (LEB128) form, so the dense, mostly
+// increasing RIDs of a surname take 1-2 bytes each instead of 4. The
+// directory (first/last RID per block) turns a lookup into a binary search
+// plus the decode of one block, and scans decode the byte stream
+// sequentially.
+//
+// Every block but the last is full, so a block's position gives the index
+// of its entries. RIDs are handed out in increasing order, so add() is
+// almost always an append to the last block. remove() locates the RID and
+// sets its bit in a tombstone bitmap (allocated on the first removal)
+// instead of re-encoding: O(log p + kBlockSize). Once half
+// the entries are tombstones the list is rebuilt without them, which keeps
+// removal amortized and the list at most twice its live size. A RID added
+// out of order (moved here by an update) also rebuilds the list.
+// Readers walk the live RIDs in ascending order (forEach), which also lets
+// two lists be intersected in one merge pass.
+class Postings {
+public:
+    static constexpr std::size_t kBlockSize = 128;   // RIDs per block
+
+private:
+    struct Block {
+        int first;              // first RID (not in data)
+        int last;               // last RID, for appends and range checks
+        std::uint32_t offset;   // start of the block's deltas in data
+    };
+
+    std::vector<std::uint8_t> data;   // varint deltas of all blocks, in order
+    std::vector<Block> blocks;        // block directory, ascending
+    std::vector<std::uint64_t> dead;  // tombstone bitmap, one bit per entry (empty: none)
+    std::size_t total = 0;            // entries, including tombstoned ones
+    std::size_t deadCount = 0;        // set bits in dead
+
+    static constexpr std::size_t npos = std::size_t(-1);
+
+public:
+    // ----- Add -----
+    // Inserts a RID (no-op if it is already live)
+    void add(int rid) {
+        if (blocks.empty() || blocks.back().last < rid) {
+            append(rid);
+            return;
+        }
+        std::size_t i = locate(rid);
+        if (i != npos) {
+            if (isDead(i)) {
+                dead[i >> 6] &= ~(std::uint64_t(1) << (i & 63));
+                --deadCount;
+            }
+            return;
+        }
+        // Out of order: rebuild with the RID in place
+        std::vector<int> live = toVector();
+        live.insert(std::lower_bound(live.begin(), live.end(), rid), rid);
+        rebuild(live);
+    }
+
+    // ----- Remove -----
+    // Tombstones a RID; returns false if it is not in the list
+    bool remove(int rid) {
+        std::size_t i = locate(rid);
+        if (i == npos || isDead(i)) return false;
+        if (dead.empty()) dead.assign((total + 63) / 64, 0);
+        dead[i >> 6] |= std::uint64_t(1) << (i & 63);
+        if (++deadCount * 2 > total) rebuild(toVector());
+        return true;
+    }
+
+    bool contains(int rid) const {
+        std::size_t i = locate(rid);
+        return i != npos && !isDead(i);
+    }
+
+    // Number of live RIDs
+    std::size_t size() const { return total - deadCount; }
+    bool empty() const { return size() == 0; }
+
+    // Heap bytes held by the encoded list (deltas, directory and bitmap)
+    std::size_t memoryBytes() const {
+        return data.capacity() + blocks.capacity() * sizeof(Block) + dead.capacity() * sizeof(std::uint64_t);
+    }
+
+    // Releases spare capacity (after a bulk load; later appends grow it again)
+    void shrinkToFit() {
+        data.shrink_to_fit();
+        blocks.shrink_to_fit();
+        dead.shrink_to_fit();
+    }
+
+    // ----- In-order Traversal -----
+    // Applies `fn(rid)` to every live RID in ascending order
+    template <typename Fn>
+    void forEach(Fn fn) const {
+        const std::uint8_t *p = data.data();
+        for (std::size_t b = 0; b < blocks.size(); ++b) {
+            int rid = blocks[b].first;
+            std::size_t base = b * kBlockSize, n = blockCount(b);
+            for (std::size_t k = 0; k < n; ++k) {
+                if (k) rid += (int)readVarint(p);
+                if (!isDead(base + k)) fn(rid);
+            }
+        }
+    }
+
+    // Applies `fn(rid)` to the live RIDs >= from in ascending order, until fn
+    // returns false; the block directory finds the starting block, so
+    // resuming a walk does not decode the part already passed
+    template <typename Fn>
+    void forEachFrom(int from, Fn fn) const {
+        auto it = std::lower_bound(blocks.begin(), blocks.end(), from,
+                                   [](const Block &blk, int r) { return blk.last < r; });
+        for (std::size_t b = it - blocks.begin(); b < blocks.size(); ++b) {
+            const std::uint8_t *p = data.data() + blocks[b].offset;
+            int rid = blocks[b].first;
+            std::size_t base = b * kBlockSize, n = blockCount(b);
+            for (std::size_t k = 0; k < n; ++k) {
+                if (k) rid += (int)readVarint(p);
+                if (rid >= from && !isDead(base + k) && !fn(rid)) return;
+            }
+        }
+    }
+
+    // Live RIDs, ascending
+    std::vector<int> toVector() const {
+        std::vector<int> out;
+        out.reserve(size());
+        forEach([&](int rid) { out.push_back(rid); });
+        return out;
+    }
+
+    // ----- Intersect -----
+    // Live RIDs present in both lists, ascending (decode, then one merge pass)
+    std::vector<int> intersect(const Postings &other) const {
+        std::vector<int> a = toVector(), b = other.toVector(), out;
+        std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(out));
+        return out;
+    }
+
+private:
+    bool isDead(std::size_t i) const { return !dead.empty() && ((dead[i >> 6] >> (i & 63)) & 1); }
+
+    // Entries in block b (all blocks but the last are full)
+    std::size_t blockCount(std::size_t b) const {
+        return b + 1 < blocks.size() ? kBlockSize : total - b * kBlockSize;
+    }
+
+    // ----- Varint coding -----
+    static void writeVarint(std::vector<std::uint8_t> &out, std::uint32_t v) {
+        while (v >= 0x80) {
+            out.push_back(std::uint8_t(v | 0x80));
+            v >>= 7;
+        }
+        out.push_back(std::uint8_t(v));
+    }
+    static std::uint32_t readVarint(const std::uint8_t *&p) {
+        std::uint32_t v = 0;
+        for (int shift = 0;; shift += 7) {
+            std::uint8_t byte = *p++;
+            v |= std::uint32_t(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) return v;
+        }
+    }
+
+    // ----- Append -----
+    // Adds a RID larger than every entry
+    void append(int rid) {
+        if (total % kBlockSize == 0) {
+            blocks.push_back({rid, rid, (std::uint32_t)data.size()});
+        } else {
+            Block &blk = blocks.back();
+            writeVarint(data, std::uint32_t(rid - blk.last));
+            blk.last = rid;
+        }
+        if (!dead.empty() && dead.size() * 64 <= total) dead.push_back(0);
+        ++total;
+    }
+
+    // ----- Locate -----
+    // Entry index of rid (tombstoned or not), or npos
+    std::size_t locate(int rid) const {
+        auto it = std::upper_bound(blocks.begin(), blocks.end(), rid,
+                                   [](int r, const Block &blk) { return r < blk.first; });
+        if (it == blocks.begin()) return npos;
+        std::size_t b = it - 1 - blocks.begin();
+        if (blocks[b].last < rid) return npos;
+        const std::uint8_t *p = data.data() + blocks[b].offset;
+        int cur = blocks[b].first;
+        for (std::size_t k = 0, n = blockCount(b); k < n; ++k) {
+            if (k) cur += (int)readVarint(p);
+            if (cur == rid) return b * kBlockSize + k;
+            if (rid < cur) break;
+        }
+        return npos;
+    }
+
+    // ----- Rebuild -----
+    // Re-encodes the list from sorted live RIDs, dropping all tombstones
+    void rebuild(const std::vector<int> &sorted) {
+        data.clear();
+        blocks.clear();
+        dead.clear();
+        total = deadCount = 0;
+        for (int rid : sorted) append(rid);
+    }
+};
+
+#endif
@@ -12,7 +12,7 @@ struct Record {
     string first;           // first name
     string major;           // major field of study
     double gpa = 0.0;       // GPA value
-    bool deleted = false;   // "tombstone" flag for soft deletion
+    bool deleted = false;   // unused: a deletion is the row's end timestamp (RecordHeap)
 };
 
 #endif
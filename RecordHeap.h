@@ -0,0 +1,245 @@
+#ifndef RECORDHEAP_H
+#define RECORDHEAP_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include "Epoch.h"
+#include "Record.h"
+
+// ================== Record Heap ==================
+// Append-only row store built from fixed-size chunks (the "heap file").
+// Rows never move once appended, and append() may run concurrently with
+// other appends and with reads of rows that were already published, which
+// neither vector (reallocates) nor deque (rebuilds its block map) allow.
+// A row becomes visible to other threads through whatever publishes its RID
+// (an index insert or a latch release), not through size().
+//
+// Every row is one version of a record (MVCC). Next to the row the heap
+// keeps its begin/end commit timestamps and the RID of the version it
+// replaced, so a reader at timestamp S sees the version with
+// begin <= S < end, and a closed end timestamp is the only mark of a
+// deletion. endVersion() closes a version; retireRow() is called once
+// nothing can reach the row any more and counts it as dead for its chunk.
+// compact() frees chunks whose rows are all dead. RIDs never change, and a freed chunk is handed to the
+// EpochDomain, so a `Record &` obtained inside an EpochGuard stays valid
+// until that guard is left even if its row is retired and compacted
+// meanwhile. Reachable rows are never freed.
+class RecordHeap {
+public:
+    static constexpr size_t kChunkBits = 14;               // 16K rows per chunk
+    static constexpr size_t kChunkSize = size_t(1) << kChunkBits;
+    static constexpr uint64_t kLive = UINT64_MAX;          // end timestamp of a current version
+    static constexpr uint64_t kNow = kLive - 1;            // read timestamp that sees current versions
+    static constexpr size_t kMaxRows = size_t(1) << 30;    // RIDs the chunk directory can address
+
+private:
+    static constexpr size_t kMaxChunks = kMaxRows >> kChunkBits;
+
+    struct Version {
+        std::atomic<uint64_t> begin{0};     // commit timestamp that created the row
+        std::atomic<uint64_t> end{kLive};   // commit timestamp that replaced or deleted it
+        std::atomic<int> prev{-1};          // RID of the previous version of the record
+    };
+
+    struct Chunk {
+        Record rows[kChunkSize];
+        Version versions[kChunkSize];
+        std::atomic<size_t> dead{0};   // rows retired
+        std::shared_ptr<std::atomic<size_t>> freedTo;   // heap counter bumped once the chunk is deleted
+    };
+
+    std::atomic<Chunk *> *chunks;    // chunk directory, allocated once
+    std::atomic<bool> *released;     // per directory slot: chunk handed to the EpochDomain
+    std::atomic<size_t> used{0};     // number of slots handed out
+    // Chunks the EpochDomain has actually deleted. Shared with the deleter,
+    // which may run after the heap is gone.
+    std::shared_ptr<std::atomic<size_t>> freed = std::make_shared<std::atomic<size_t>>(0);
+
+public:
+    RecordHeap()
+        : chunks(new std::atomic<Chunk *>[kMaxChunks]()), released(new std::atomic<bool>[kMaxChunks]()) {}
+    ~RecordHeap() {
+        clear();
+        delete[] chunks;
+        delete[] released;
+    }
+
+    // ----- Ownership -----
+    RecordHeap(const RecordHeap &) = delete;
+    RecordHeap &operator=(const RecordHeap &) = delete;
+    RecordHeap(RecordHeap &&other) noexcept
+        : chunks(other.chunks), released(other.released), used(other.used.load()), freed(std::move(other.freed)) {
+        other.chunks = new std::atomic<Chunk *>[kMaxChunks]();
+        other.released = new std::atomic<bool>[kMaxChunks]();
+        other.used = 0;
+        other.freed = std::make_shared<std::atomic<size_t>>(0);
+    }
+
+    // ----- Append -----
+    // Copies the row into the next free slot as a version that begins at
+    // beginTs and replaces version prevRID; returns its RID. Thread-safe.
+    size_t append(const Record &r, uint64_t beginTs = 0, int prevRID = -1) {
+        size_t rid = used.fetch_add(1);
+        Chunk *chunk = chunkFor(rid);
+        size_t slot = rid & (kChunkSize - 1);
+        chunk->rows[slot] = r;
+        chunk->versions[slot].begin.store(beginTs);
+        chunk->versions[slot].prev.store(prevRID);
+        return rid;
+    }
+    void push_back(const Record &r) { append(r); }
+
+    // ----- Append batch -----
+    // Appends n rows as versions beginning at beginTs, reserving their n
+    // consecutive RIDs at once; returns the RID of the first. Thread-safe.
+    size_t appendBatch(const Record *rows, size_t n, uint64_t beginTs = 0) {
+        size_t first = used.fetch_add(n);
+        for (size_t i = 0; i < n; ) {
+            size_t rid = first + i;
+            Chunk *chunk = chunkFor(rid);
+            size_t slot = rid & (kChunkSize - 1);
+            size_t run = std::min(n - i, kChunkSize - slot);   // rows that fit in this chunk
+            for (size_t k = 0; k < run; ++k) {
+                chunk->rows[slot + k] = rows[i + k];
+                chunk->versions[slot + k].begin.store(beginTs);
+                chunk->versions[slot + k].prev.store(-1);
+            }
+            i += run;
+        }
+        return first;
+    }
+
+    // ----- Access -----
+    // (only for rows not yet reclaimed by compact())
+    Record &operator[](size_t rid) {
+        return chunks[rid >> kChunkBits].load(std::memory_order_acquire)->rows[rid & (kChunkSize - 1)];
+    }
+    const Record &operator[](size_t rid) const {
+        return chunks[rid >> kChunkBits].load(std::memory_order_acquire)->rows[rid & (kChunkSize - 1)];
+    }
+    Record &back() { return (*this)[size() - 1]; }
+
+    // Starts loading a row and its version stamps into cache (a hint only)
+    void prefetch(size_t rid) const {
+        const Chunk *chunk = chunks[rid >> kChunkBits].load(std::memory_order_acquire);
+        __builtin_prefetch(&chunk->rows[rid & (kChunkSize - 1)]);
+        __builtin_prefetch(&chunk->versions[rid & (kChunkSize - 1)]);
+    }
+
+    size_t size() const { return used.load(); }
+    bool empty() const { return size() == 0; }
+
+    // Rows still held in memory (size() minus rows in chunks compact()
+    // released and the EpochDomain has since deleted). A released chunk
+    // that a guard still pins counts as resident until it is really freed.
+    size_t residentRows() const { return size() - freed->load() * kChunkSize; }
+
+    // Whether the chunk of rid has not been released by compact(); scans
+    // check it inside an EpochGuard before touching the chunk's rows
+    bool resident(size_t rid) const { return !released[rid >> kChunkBits].load(); }
+
+    // ----- Versions -----
+    uint64_t beginTs(size_t rid) const { return version(rid).begin.load(); }
+    uint64_t endTs(size_t rid) const { return version(rid).end.load(); }
+    int prevVersion(size_t rid) const { return version(rid).prev.load(); }
+    void setPrevVersion(size_t rid, int prevRID) { version(rid).prev.store(prevRID); }
+
+    // Whether the row is the version a reader at timestamp S sees
+    bool visibleAt(size_t rid, uint64_t S) const {
+        const Version &v = version(rid);
+        return v.begin.load() <= S && S < v.end.load();
+    }
+
+    // Closes a current version at timestamp ts. Returns false if it was
+    // already closed, so of several racing deletes exactly one succeeds.
+    // Only the version stamp changes: the row itself is never written, so
+    // lock-free readers may copy it meanwhile.
+    bool endVersion(size_t rid, uint64_t ts) {
+        uint64_t live = kLive;
+        return version(rid).end.compare_exchange_strong(live, ts);
+    }
+
+    // ----- Retire -----
+    // Counts a closed row that no index, postings list or version chain
+    // reaches any more as dead. Each row must be retired at most once.
+    void retireRow(size_t rid) {
+        chunks[rid >> kChunkBits].load(std::memory_order_acquire)->dead.fetch_add(1);
+    }
+
+    // ----- Compact -----
+    // Releases every chunk whose rows are all retired and returns the number
+    // of rows released. Safe to run alongside appends, deletes and readers
+    // that only reach unretired rows (or hold an EpochGuard): a fully dead
+    // chunk gets no more appends, and it is freed only after the current
+    // guards end. compact() then asks the EpochDomain to reclaim at once
+    // instead of waiting for its periodic scan, so without such readers the
+    // memory is gone when it returns (and a later compact() frees chunks an
+    // earlier one had to leave pinned). residentRows() drops only on free.
+    // The directory keeps pointing at a released chunk: a reader that got one
+    // of its RIDs before it was retired still finds the memory until its
+    // guard ends, and nothing else can reach those RIDs any more.
+    size_t compact() {
+        size_t reclaimed = 0;
+        size_t full = used.load() >> kChunkBits;   // chunks every slot of which was handed out
+        for (size_t c = 0; c < full; ++c) {
+            if (released[c].load()) continue;
+            Chunk *chunk = chunks[c].load(std::memory_order_acquire);
+            if (chunk->dead.load() != kChunkSize || released[c].exchange(true)) continue;
+            chunk->freedTo = freed;
+            EpochDomain::instance().retire(chunk, [](void *p) {
+                Chunk *dead = static_cast<Chunk *>(p);
+                dead->freedTo->fetch_add(1);
+                delete dead;
+            });
+            reclaimed += kChunkSize;
+        }
+        EpochDomain::instance().reclaim();
+        return reclaimed;
+    }
+
+    // ----- Clear -----
+    // Frees every chunk. Not thread-safe: no other thread may use the heap.
+    void clear() {
+        size_t n = (used.load() + kChunkSize - 1) >> kChunkBits;
+        for (size_t c = 0; c < n; ++c) {
+            Chunk *chunk = chunks[c].exchange(nullptr);
+            if (!released[c].exchange(false)) delete chunk;   // released chunks belong to the EpochDomain
+        }
+        used = 0;
+        freed = std::make_shared<std::atomic<size_t>>(0);   // chunks still pending count elsewhere
+    }
+
+private:
+    Version &version(size_t rid) {
+        return chunks[rid >> kChunkBits].load(std::memory_order_acquire)->versions[rid & (kChunkSize - 1)];
+    }
+    const Version &version(size_t rid) const {
+        return chunks[rid >> kChunkBits].load(std::memory_order_acquire)->versions[rid & (kChunkSize - 1)];
+    }
+
+    // ----- Chunk lookup / lazy allocation -----
+    // Racing appenders may both allocate the same chunk; the CAS loser frees its copy.
+    // A RID past kMaxRows has no directory slot: the heap is full and the
+    // process stops here rather than write past the directory.
+    Chunk *chunkFor(size_t rid) {
+        if (rid >= kMaxRows) {
+            std::fprintf(stderr, "RecordHeap: capacity of %zu rows exceeded\n", kMaxRows);
+            std::abort();
+        }
+        std::atomic<Chunk *> &slot = chunks[rid >> kChunkBits];
+        Chunk *chunk = slot.load(std::memory_order_acquire);
+        if (chunk) return chunk;
+        Chunk *fresh = new Chunk;
+        if (slot.compare_exchange_strong(chunk, fresh, std::memory_order_acq_rel))
+            return fresh;
+        delete fresh;
+        return chunk;
+    }
+};
+
+#endif
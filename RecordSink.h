@@ -0,0 +1,135 @@
+#ifndef RECORDSINK_H
+#define RECORDSINK_H
+
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include "Record.h"
+
+// ================== Buffered File ==================
+// Write-only file behind one large buffer, so a stream of small appends
+// turns into few large write() calls. Errors are sticky: after a failed
+// open or write, appends are dropped and close() returns false.
+class BufferedFile {
+    int fd = -1;
+    std::vector<char> buffer;
+    size_t used = 0;
+    bool ok = false;
+
+public:
+    static constexpr size_t kDefaultBufferBytes = size_t(1) << 20;
+
+    explicit BufferedFile(const std::string &path, size_t bufferBytes = kDefaultBufferBytes)
+        : fd(::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644)), buffer(bufferBytes), ok(fd >= 0) {}
+    ~BufferedFile() { close(); }
+    BufferedFile(const BufferedFile &) = delete;
+    BufferedFile &operator=(const BufferedFile &) = delete;
+
+    bool good() const { return ok; }
+
+    void append(const void *data, size_t n) {
+        if (!ok) return;
+        if (buffer.size() - used < n) {
+            flush();
+            if (n >= buffer.size()) {   // larger than the buffer: write it directly
+                writeAll(static_cast<const char *>(data), n);
+                return;
+            }
+        }
+        std::memcpy(buffer.data() + used, data, n);
+        used += n;
+    }
+    template <typename T>
+    void put(const T &v) { append(&v, sizeof(T)); }
+
+    // Room for up to n bytes at the end of the buffer, filled by the caller
+    // and then committed with advance() (for in-place formatting)
+    char *reserve(size_t n) {
+        if (buffer.size() - used < n) flush();
+        if (buffer.size() < n) buffer.resize(n);
+        return buffer.data() + used;
+    }
+    void advance(size_t n) { used += n; }
+
+    // Writes out what is buffered; returns false on any error so far
+    bool flush() {
+        if (ok && used) writeAll(buffer.data(), used);
+        used = 0;
+        return ok;
+    }
+
+    // Flushes and closes the file; returns false on any error so far
+    bool close() {
+        if (fd < 0) return false;
+        flush();
+        ok = ::close(fd) == 0 && ok;
+        fd = -1;
+        return ok;
+    }
+
+private:
+    void writeAll(const char *p, size_t n) {
+        while (ok && n > 0) {
+            ssize_t w = ::write(fd, p, n);
+            ok = w > 0;
+            if (ok) {
+                p += w;
+                n -= (size_t)w;
+            }
+        }
+    }
+};
+
+// ================== CSV Sink ==================
+// Record sink (see Engine::exportRangeById) that writes one
+// id,last,first,major,gpa line per record, the format CsvImporter reads, so
+// an export can be imported again. Numbers are formatted with
+// std::to_chars straight into the file buffer (GPA in its shortest form
+// that reads back as the same double); strings are copied verbatim.
+class CsvSink {
+    BufferedFile file;
+    char delimiter;
+    size_t rows = 0;
+
+public:
+    explicit CsvSink(const std::string &path, char delimiterIn = ',', bool header = true,
+                     size_t bufferBytes = BufferedFile::kDefaultBufferBytes)
+        : file(path, bufferBytes), delimiter(delimiterIn) {
+        if (header) {
+            const char names[][6] = {"id", "last", "first", "major", "gpa"};
+            for (int i = 0; i < 5; ++i) {
+                if (i) file.put(delimiter);
+                file.append(names[i], std::strlen(names[i]));
+            }
+            file.put('\n');
+        }
+    }
+
+    bool add(const Record &rec) {
+        // 11 bytes for the ID, 24 for the GPA, 5 separators
+        char *start = file.reserve(rec.last.size() + rec.first.size() + rec.major.size() + 40);
+        char *p = std::to_chars(start, start + 11, rec.id).ptr;
+        for (const std::string *text : {&rec.last, &rec.first, &rec.major}) {
+            *p++ = delimiter;
+            std::memcpy(p, text->data(), text->size());
+            p += text->size();
+        }
+        *p++ = delimiter;
+        p = std::to_chars(p, p + 24, rec.gpa).ptr;
+        *p++ = '\n';
+        file.advance((size_t)(p - start));
+        ++rows;
+        return file.good();
+    }
+
+    size_t count() const { return rows; }
+
+    // Writes out the rest and closes the file; false on any I/O error
+    bool finish() { return file.close(); }
+};
+
+#endif
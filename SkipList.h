@@ -0,0 +1,312 @@
+#ifndef SKIPLIST_H
+#define SKIPLIST_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include "BST.h"
+#include "Epoch.h"
+
+// ================== Lock-free Skip List ==================
+// Concurrent ordered index with the same interface as BST<K, V> (find,
+// insert, erase, rangeApply, forEach, size, stats), after Fraser's and
+// Herlihy & Shavit's lock-free skip lists.
+//
+// Each node sits on a tower of `height` forward links. The low bit of a link
+// marks its owner as deleted at that level. Erase marks the tower top-down
+// (the level-0 mark is the linearization point, so exactly one of several
+// racing erases wins), then a search unlinks the marked node physically.
+// Insert publishes a node with one CAS at level 0 and then links the upper
+// levels one by one. Lookups and range scans never write: they skip marked
+// nodes instead of unlinking them, so they never wait on a writer.
+//
+// Erased nodes are freed through the EpochDomain once no reader inside an
+// EpochGuard can still hold them. Every public operation enters its own guard.
+//
+// K - key type, must support comparison operators (<, ==) and be default constructible
+// V - value type; each value sits in its own immutable box that assign()
+//     swaps atomically (the old box is epoch-retired), so lookups return copies
+template <typename K, typename V>
+class SkipList {
+    static constexpr int kMaxLevel = 16;   // enough for ~4^16 keys with p = 1/4
+
+    // ----- Internal Node structure -----
+    struct Node {
+        K key;                         // key used for ordering
+        std::atomic<const V *> val;    // associated value (payload), replaced by assign()
+        int height;                    // number of levels this node is linked on
+        std::atomic<int> state{0};     // kLinked / kRemoved handshake (see release())
+        std::atomic<std::uintptr_t> *next; // forward links, low bit = deleted mark
+
+        Node(const K &k, const V &v, int h)
+            : key(k), val(new V(v)), height(h), next(new std::atomic<std::uintptr_t>[h]) {
+            for (int i = 0; i < h; ++i) next[i].store(0, std::memory_order_relaxed);
+        }
+        ~Node() {
+            delete val.load();
+            delete[] next;
+        }
+    };
+
+    enum : int { kLinked = 1, kRemoved = 2 };
+
+    Node *head;                          // sentinel tower of kMaxLevel links
+    std::atomic<std::size_t> count{0};   // number of live keys
+
+public:
+    static constexpr bool selfAdjusting = false; // lookups never modify the list
+    static constexpr bool concurrent = true;     // insert/erase/find may run in parallel
+    static constexpr bool persistent = false;    // updates modify the list in place
+
+    SkipList() : head(new Node(K{}, V{}, kMaxLevel)) {}
+    SkipList(const SkipList &) = delete;
+    SkipList &operator=(const SkipList &) = delete;
+
+    // ----- Destructor (no other thread may use the list) -----
+    ~SkipList() {
+        Node *n = head;
+        while (n) {
+            Node *next = ptr(n->next[0].load());
+            delete n;
+            n = next;
+        }
+    }
+
+    // ----- Insert -----
+    // Returns true if inserted, false if the key already exists
+    bool insert(const K &k, const V &v) {
+        EpochGuard guard;
+        int cmp = 0;
+        Node *preds[kMaxLevel], *succs[kMaxLevel];
+        Node *node = nullptr;
+        for (;;) {
+            if (locate(k, preds, succs, cmp)) {
+                delete node;   // never published
+                return false;
+            }
+            if (!node) node = new Node(k, v, randomHeight());
+            for (int i = 0; i < node->height; ++i)
+                node->next[i].store(word(succs[i]), std::memory_order_relaxed);
+            std::uintptr_t expected = word(succs[0]);
+            if (preds[0]->next[0].compare_exchange_strong(expected, word(node))) break;
+        }
+        ++count;
+
+        // Link the upper levels; stop early if an erase marked the node meanwhile
+        for (int i = 1; i < node->height; ++i) {
+            for (;;) {
+                std::uintptr_t cur = node->next[i].load();
+                if (isMarked(cur)) {
+                    i = node->height;
+                    break;
+                }
+                if (ptr(cur) != succs[i] && !node->next[i].compare_exchange_strong(cur, word(succs[i])))
+                    continue;
+                std::uintptr_t expected = word(succs[i]);
+                if (preds[i]->next[i].compare_exchange_strong(expected, word(node))) break;
+                locate(k, preds, succs, cmp);
+            }
+        }
+        release(node, kLinked);
+        return true;
+    }
+
+    // ----- Find -----
+    // Returns a copy of the value stored under k, or nullopt
+    std::optional<V> find(const K &k) const {
+        int cmp = 0;
+        return find(k, cmp);
+    }
+    std::optional<V> find(const K &k, int &cmp) const {
+        EpochGuard guard;
+        const Node *n = lowerBound(k, cmp);
+        if (n) {
+            ++cmp;
+            if (n->key == k) return *n->val.load();
+        }
+        return std::nullopt;
+    }
+
+    // ----- Erase -----
+    // Removes k; if oldOut is given it receives the removed value.
+    // Of several threads erasing the same key exactly one succeeds.
+    bool erase(const K &k, V *oldOut = nullptr) {
+        EpochGuard guard;
+        int cmp = 0;
+        Node *preds[kMaxLevel], *succs[kMaxLevel];
+        if (!locate(k, preds, succs, cmp)) return false;
+        Node *victim = succs[0];
+
+        // Mark the upper levels top-down, then level 0 (the actual delete)
+        for (int i = victim->height - 1; i >= 1; --i) {
+            std::uintptr_t cur = victim->next[i].load();
+            while (!isMarked(cur) && !victim->next[i].compare_exchange_weak(cur, cur | 1)) {}
+        }
+        std::uintptr_t cur = victim->next[0].load();
+        for (;;) {
+            if (isMarked(cur)) return false;   // a concurrent erase got there first
+            if (victim->next[0].compare_exchange_weak(cur, cur | 1)) break;
+        }
+        if (oldOut) *oldOut = *victim->val.load();
+        --count;
+        release(victim, kRemoved);
+        return true;
+    }
+
+    // ----- Assign -----
+    // Replaces the value stored under k. Returns false if k is not present.
+    bool assign(const K &k, const V &v) {
+        EpochGuard guard;
+        int cmp = 0;
+        Node *n = const_cast<Node *>(lowerBound(k, cmp));
+        if (!n || !(n->key == k)) return false;
+        const V *old = n->val.exchange(new V(v));
+        EpochDomain::instance().retire(const_cast<V *>(old));
+        return true;
+    }
+
+    // ----- Range Apply -----
+    // Applies `fn(key, value)` to all keys in [lo, hi] in ascending order
+    // (until fn returns false, see visitInRange). Not a snapshot: keys
+    // inserted or erased concurrently may or may not be seen.
+    template <typename Fn>
+    void rangeApply(const K &lo, const K &hi, Fn fn) const {
+        int cmp = 0;
+        rangeApply(lo, hi, fn, cmp);
+    }
+    template <typename Fn>
+    void rangeApply(const K &lo, const K &hi, Fn fn, int &cmp) const {
+        EpochGuard guard;
+        for (const Node *n = lowerBound(lo, cmp); n; ) {
+            std::uintptr_t succ = n->next[0].load();
+            if (!isMarked(succ)) {
+                ++cmp;
+                if (hi < n->key || !visitInRange(fn, n->key, *n->val.load())) break;
+            }
+            n = ptr(succ);
+        }
+    }
+
+    // ----- In-order Traversal -----
+    // Applies `fn(key, value)` to every live key in ascending order (no comparisons counted)
+    template <typename Fn>
+    void forEach(Fn fn) const {
+        EpochGuard guard;
+        for (const Node *n = ptr(head->next[0].load()); n; ) {
+            std::uintptr_t succ = n->next[0].load();
+            if (!isMarked(succ)) fn(n->key, *n->val.load());
+            n = ptr(succ);
+        }
+    }
+
+    std::size_t size() const { return count.load(); }
+    bool empty() const { return size() == 0; }
+
+    // ----- Shape statistics (quiescent use only) -----
+    // For a skip list levelFill[i] counts the towers reaching level i (so
+    // levelFill[0] = nodes), height is the number of levels in use and
+    // avgDepth the mean tower height.
+    TreeStats stats() const {
+        TreeStats st;
+        double heightSum = 0;
+        for (const Node *n = ptr(head->next[0].load()); n; n = ptr(n->next[0].load())) {
+            if ((int)st.levelFill.size() < n->height) st.levelFill.resize(n->height, 0);
+            for (int i = 0; i < n->height; ++i) ++st.levelFill[i];
+            ++st.nodes;
+            heightSum += n->height;
+        }
+        st.height = (int)st.levelFill.size();
+        st.maxDepth = st.height - 1;
+        if (st.nodes) st.avgDepth = heightSum / st.nodes;
+        return st;
+    }
+
+private:
+    // ----- Marked link helpers -----
+    static Node *ptr(std::uintptr_t w) { return reinterpret_cast<Node *>(w & ~std::uintptr_t(1)); }
+    static bool isMarked(std::uintptr_t w) { return w & 1; }
+    static std::uintptr_t word(const Node *n) { return reinterpret_cast<std::uintptr_t>(n); }
+
+    // ----- Helper: geometric tower height (p = 1/4) -----
+    static int randomHeight() {
+        thread_local std::uint32_t seed = 2463534242u ^ (std::uint32_t)(std::uintptr_t)&seed;
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        int h = 1;
+        for (std::uint32_t bits = seed; h < kMaxLevel && (bits & 3) == 0; bits >>= 2) ++h;
+        return h;
+    }
+
+    // ----- Release -----
+    // A node is unreachable only after its inserter stopped linking it and
+    // its eraser marked it. Whichever of the two finishes second unlinks it
+    // from every level it ended up on and retires it.
+    void release(Node *n, int flag) {
+        if (!(n->state.fetch_or(flag) & (kLinked | kRemoved) & ~flag)) return;
+        int cmp = 0;
+        Node *preds[kMaxLevel], *succs[kMaxLevel];
+        locate(n->key, preds, succs, cmp);
+        EpochDomain::instance().retire(n);
+    }
+
+    // ----- Locate -----
+    // Fills preds/succs with the neighbours of k on every level, unlinking
+    // marked nodes on the way. Returns true if an unmarked node with key k
+    // is linked at level 0 (it is then succs[0]).
+    bool locate(const K &k, Node **preds, Node **succs, int &cmp) {
+        while (!tryLocate(k, preds, succs, cmp)) {}
+        if (!succs[0]) return false;
+        ++cmp;
+        return succs[0]->key == k;
+    }
+    // One pass of locate; false if an unlink CAS lost a race (restart from the top)
+    bool tryLocate(const K &k, Node **preds, Node **succs, int &cmp) {
+        Node *pred = head;
+        for (int i = kMaxLevel - 1; i >= 0; --i) {
+            Node *curr = ptr(pred->next[i].load());
+            while (curr) {
+                std::uintptr_t succ = curr->next[i].load();
+                if (isMarked(succ)) {
+                    std::uintptr_t expected = word(curr);
+                    if (!pred->next[i].compare_exchange_strong(expected, word(ptr(succ))))
+                        return false;
+                    curr = ptr(succ);
+                    continue;
+                }
+                ++cmp;
+                if (!(curr->key < k)) break;
+                pred = curr;
+                curr = ptr(succ);
+            }
+            preds[i] = pred;
+            succs[i] = curr;
+        }
+        return true;
+    }
+
+    // ----- Read-only search -----
+    // First unmarked level-0 node with key >= k (or nullptr); skips marked
+    // nodes without unlinking them
+    const Node *lowerBound(const K &k, int &cmp) const {
+        const Node *pred = head;
+        const Node *curr = nullptr;
+        for (int i = kMaxLevel - 1; i >= 0; --i) {
+            curr = ptr(pred->next[i].load());
+            while (curr) {
+                std::uintptr_t succ = curr->next[i].load();
+                if (!isMarked(succ)) {
+                    ++cmp;
+                    if (!(curr->key < k)) break;
+                    pred = curr;
+                }
+                curr = ptr(succ);
+            }
+        }
+        return curr;
+    }
+};
+
+#endif
@@ -0,0 +1,243 @@
+#ifndef SNAPSHOTFILE_H
+#define SNAPSHOTFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+// ================== Snapshot Image ==================
+// In-memory form of a snapshot file (see Engine::save / Engine::load): the
+// live rows in ascending ID order as fixed-width columns, with every string
+// replaced by its index into a string table (repeated values such as majors
+// and surnames are stored once), and lastIndex as its sorted keys, each
+// with the ascending row positions it lists. Loading can then bulk-build
+// both indexes from already sorted input instead of parsing text and
+// inserting row by row.
+struct SnapshotImage {
+    std::vector<std::string> strings;   // string table
+    std::vector<int32_t> ids;           // one entry per row, strictly ascending
+    std::vector<double> gpas;
+    std::vector<uint32_t> lasts, firsts, majors;   // string table indexes
+    std::vector<uint32_t> keyNames;     // lastIndex keys (string indexes), strictly ascending
+    std::vector<uint32_t> keyCounts;    // row positions listed per key
+    std::vector<uint32_t> keyRows;      // all keys' row positions, each key's ascending
+    uint64_t logPosition = 0;           // last write-ahead log LSN the rows reflect
+
+    size_t rows() const { return ids.size(); }
+
+    // Returns the table index of s, adding it on first use. The lookup is
+    // keyed by views of the callers' strings, so every interned string must
+    // stay alive and unchanged while the image is being built.
+    uint32_t intern(const std::string &s) {
+        auto found = lookup.emplace(std::string_view(s), (uint32_t)strings.size());
+        if (found.second) strings.push_back(s);
+        return found.first->second;
+    }
+
+    // Adds s to the table without looking for an earlier copy (for columns
+    // whose values are nearly all distinct, where the lookup only costs time)
+    uint32_t add(const std::string &s) {
+        strings.push_back(s);
+        return (uint32_t)strings.size() - 1;
+    }
+
+    // Expected number of rows, to size the columns and the lookup up front
+    void reserve(size_t rows) {
+        ids.reserve(rows);
+        gpas.reserve(rows);
+        lasts.reserve(rows);
+        firsts.reserve(rows);
+        majors.reserve(rows);
+        strings.reserve(rows);
+    }
+
+private:
+    std::unordered_map<std::string_view, uint32_t> lookup;   // writer side only
+};
+
+// ================== Snapshot File ==================
+// Binary layout (native byte order, written and read on the same machine):
+//   header       magic "BSTSNAP1", version, row/string/key/entry counts,
+//                write-ahead log position
+//   strings      per string: u32 length, bytes
+//   columns      i32 id[rows], f64 gpa[rows], u32 last/first/major[rows]
+//   lastIndex    per key: u32 name, u32 count; then u32 row[entries]
+// Columns are written straight from their vectors, and read() takes the
+// file in one read and copies each column out with one memcpy, so both
+// directions run at disk speed. read() validates every count, index and
+// ordering, so a truncated or corrupt file is rejected instead of loaded.
+class SnapshotFile {
+    static constexpr char kMagic[8] = {'B', 'S', 'T', 'S', 'N', 'A', 'P', '1'};
+    static constexpr uint32_t kVersion = 2;
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t reserved;
+        uint64_t rows;
+        uint64_t strings;
+        uint64_t keys;
+        uint64_t entries;
+        uint64_t logPosition;
+    };
+
+public:
+    // ----- Write -----
+    // Writes the image to path, replacing it only once the whole image is on
+    // disk: it goes to path.tmp, which is synced and renamed over path, so a
+    // crash leaves the old snapshot or the new one (a log truncated up to
+    // the new one's position relies on that). Returns false on an I/O error.
+    static bool write(const std::string &path, const SnapshotImage &image) {
+        std::string tmpPath = path + ".tmp";
+        std::FILE *f = std::fopen(tmpPath.c_str(), "wb");
+        if (!f) return false;
+        std::vector<char> buffer(1 << 20);
+        std::setvbuf(f, buffer.data(), _IOFBF, buffer.size());
+
+        Header h{};
+        std::memcpy(h.magic, kMagic, sizeof(kMagic));
+        h.version = kVersion;
+        h.rows = image.rows();
+        h.strings = image.strings.size();
+        h.keys = image.keyNames.size();
+        h.entries = image.keyRows.size();
+        h.logPosition = image.logPosition;
+        bool ok = std::fwrite(&h, sizeof(h), 1, f) == 1;
+
+        for (const std::string &s : image.strings) {
+            uint32_t len = (uint32_t)s.size();
+            ok = ok && std::fwrite(&len, sizeof(len), 1, f) == 1;
+            ok = ok && (len == 0 || std::fwrite(s.data(), 1, len, f) == len);
+        }
+        ok = ok && writeColumn(f, image.ids) && writeColumn(f, image.gpas) &&
+             writeColumn(f, image.lasts) && writeColumn(f, image.firsts) && writeColumn(f, image.majors);
+        for (size_t i = 0; ok && i < image.keyNames.size(); ++i) {
+            uint32_t pair[2] = {image.keyNames[i], image.keyCounts[i]};
+            ok = std::fwrite(pair, sizeof(pair), 1, f) == 1;
+        }
+        ok = ok && writeColumn(f, image.keyRows);
+
+        ok = std::fflush(f) == 0 && ok;
+        ok = ok && ::fsync(fileno(f)) == 0;
+        ok = std::fclose(f) == 0 && ok;
+        ok = ok && std::rename(tmpPath.c_str(), path.c_str()) == 0 && syncDirectoryOf(path);
+        if (!ok) std::remove(tmpPath.c_str());
+        return ok;
+    }
+
+    // ----- Read -----
+    // Reads path into image. Returns false if the file cannot be read or is
+    // not a valid snapshot (image is then unspecified).
+    static bool read(const std::string &path, SnapshotImage &image) {
+        std::vector<char> file;
+        if (!readAll(path, file)) return false;
+        const char *p = file.data(), *end = p + file.size();
+
+        Header h;
+        if (!take(p, end, &h, sizeof(h))) return false;
+        if (std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0 || h.version != kVersion) return false;
+        image.logPosition = h.logPosition;
+        // every row, string and entry takes at least 4 bytes, which bounds
+        // the counts by the file size before anything is allocated
+        if (h.rows > file.size() / 4 || h.strings > file.size() / 4 ||
+            h.keys > file.size() / 4 || h.entries > file.size() / 4)
+            return false;
+
+        // 1. String table
+        image.strings.resize(h.strings);
+        for (std::string &s : image.strings) {
+            uint32_t len;
+            if (!take(p, end, &len, sizeof(len)) || (size_t)(end - p) < len) return false;
+            s.assign(p, len);
+            p += len;
+        }
+
+        // 2. Columns
+        if (!readColumn(p, end, image.ids, h.rows) || !readColumn(p, end, image.gpas, h.rows) ||
+            !readColumn(p, end, image.lasts, h.rows) || !readColumn(p, end, image.firsts, h.rows) ||
+            !readColumn(p, end, image.majors, h.rows))
+            return false;
+        for (size_t i = 0; i < h.rows; ++i) {
+            if (i > 0 && image.ids[i - 1] >= image.ids[i]) return false;
+            if (image.lasts[i] >= h.strings || image.firsts[i] >= h.strings || image.majors[i] >= h.strings)
+                return false;
+        }
+
+        // 3. lastIndex
+        image.keyNames.resize(h.keys);
+        image.keyCounts.resize(h.keys);
+        uint64_t listed = 0;
+        for (size_t i = 0; i < h.keys; ++i) {
+            uint32_t pair[2];
+            if (!take(p, end, pair, sizeof(pair)) || pair[0] >= h.strings) return false;
+            if (i > 0 && !(image.strings[image.keyNames[i - 1]] < image.strings[pair[0]])) return false;
+            image.keyNames[i] = pair[0];
+            image.keyCounts[i] = pair[1];
+            listed += pair[1];
+        }
+        if (listed != h.entries || !readColumn(p, end, image.keyRows, h.entries)) return false;
+        size_t at = 0;
+        for (uint32_t count : image.keyCounts) {
+            for (uint32_t k = 0; k < count; ++k, ++at) {
+                if (image.keyRows[at] >= h.rows) return false;
+                if (k > 0 && image.keyRows[at - 1] >= image.keyRows[at]) return false;
+            }
+        }
+        return p == end;
+    }
+
+private:
+    template <typename T>
+    static bool writeColumn(std::FILE *f, const std::vector<T> &col) {
+        return col.empty() || std::fwrite(col.data(), sizeof(T), col.size(), f) == col.size();
+    }
+
+    // Copies the next n bytes into out; false if the file ends first
+    static bool take(const char *&p, const char *end, void *out, size_t n) {
+        if ((size_t)(end - p) < n) return false;
+        std::memcpy(out, p, n);
+        p += n;
+        return true;
+    }
+    template <typename T>
+    static bool readColumn(const char *&p, const char *end, std::vector<T> &col, uint64_t n) {
+        if ((uint64_t)(end - p) / sizeof(T) < n) return false;
+        col.resize(n);
+        return take(p, end, col.data(), n * sizeof(T));
+    }
+
+    // ----- Whole-file read (one allocation, one fread) -----
+    // Syncs the directory holding path, so a rename into it is durable
+    static bool syncDirectoryOf(const std::string &path) {
+        size_t slash = path.rfind('/');
+        std::string dir = slash == std::string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+        int d = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+        if (d < 0) return false;
+        bool ok = ::fsync(d) == 0;
+        ::close(d);
+        return ok;
+    }
+
+    static bool readAll(const std::string &path, std::vector<char> &out) {
+        std::FILE *f = std::fopen(path.c_str(), "rb");
+        if (!f) return false;
+        bool ok = std::fseek(f, 0, SEEK_END) == 0;
+        long size = ok ? std::ftell(f) : -1;
+        ok = size >= 0 && std::fseek(f, 0, SEEK_SET) == 0;
+        if (ok) {
+            out.resize((size_t)size);
+            ok = size == 0 || std::fread(out.data(), 1, out.size(), f) == out.size();
+        }
+        std::fclose(f);
+        return ok;
+    }
+};
+
+#endif
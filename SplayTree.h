@@ -0,0 +1,304 @@
+#ifndef SPLAYTREE_H
+#define SPLAYTREE_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "BST.h"
+
+// ================== Splay Tree ==================
+// Self-adjusting BST with the same interface as BST<K, V>.
+// Every insert/find/erase splays the touched key to the root, so keys that
+// are looked up often stay near the top and cost only a few comparisons,
+// while any sequence of m operations costs O(m log n) amortized.
+// K - key type, must support comparison operators (<, ==)
+// V - value type (data stored in each node)
+//
+// Note: find() restructures the tree, so even lookups are writes (callers
+// that lock must take an exclusive lock, see `selfAdjusting`). Splaying
+// is done top-down (iteratively) because a splay tree can temporarily be a
+// long chain and recursion that deep would overflow the stack.
+template <typename K, typename V>
+class SplayBST {
+    // ----- Internal Node structure -----
+    struct Node {
+        K key;       // key used for ordering
+        V val;       // associated value (payload)
+        Node *left;  // pointer to left child (keys smaller than this node)
+        Node *right; // pointer to right child (keys larger than this node)
+
+        Node(const K &k, const V &v)
+            : key(k), val(v), left(nullptr), right(nullptr) {}
+    };
+
+    Node *root = nullptr;  // root pointer, always the most recently touched key
+    std::size_t count = 0; // number of nodes
+
+public:
+    static constexpr bool selfAdjusting = true; // lookups modify the tree
+    static constexpr bool concurrent = false;   // callers must serialize all access
+    static constexpr bool persistent = false;   // updates modify nodes in place
+
+    int comparisons = 0;   // counts number of comparisons made (for performance analysis)
+
+    SplayBST() = default;
+    SplayBST(const SplayBST &) = delete;
+    SplayBST &operator=(const SplayBST &) = delete;
+    SplayBST(SplayBST &&other) noexcept { swapWith(other); }
+    SplayBST &operator=(SplayBST &&other) noexcept {
+        if (this != &other) {
+            clear();
+            swapWith(other);
+        }
+        return *this;
+    }
+
+    // ----- Destructor -----
+    ~SplayBST() { clear(); }
+
+    // ----- Insert -----
+    // Inserts (key, value) and makes it the root
+    // Returns true if inserted successfully, false if key already exists
+    bool insert(const K &k, const V &v) {
+        if (!root) {
+            root = new Node(k, v);
+            ++count;
+            return true;
+        }
+        // (the final comparisons against the new root were already
+        // counted inside splay, so they are not counted again here)
+        root = splay(root, k, comparisons);
+        if (k == root->key)
+            return false; // duplicate key not allowed
+
+        // Split the splayed tree around the new key
+        Node *n = new Node(k, v);
+        if (k < root->key) {
+            n->left = root->left;
+            n->right = root;
+            root->left = nullptr;
+        } else {
+            n->right = root->right;
+            n->left = root;
+            root->right = nullptr;
+        }
+        root = n;
+        ++count;
+        return true;
+    }
+
+    // ----- Find -----
+    // Returns a pointer to the value associated with the key, or nullptr.
+    // The key (or its nearest neighbour when missing) becomes the new root.
+    V *find(const K &k) {
+        return find(k, comparisons);
+    }
+    V *find(const K &k, int &cmp) {
+        if (!root) return nullptr;
+        root = splay(root, k, cmp);
+        return k == root->key ? &root->val : nullptr;
+    }
+
+    // ----- Assign -----
+    // Replaces the value stored under k (splaying it to the root).
+    // Returns false if k is not in the tree.
+    bool assign(const K &k, const V &v) {
+        V *p = find(k);
+        if (!p) return false;
+        *p = v;
+        return true;
+    }
+
+    // ----- Erase -----
+    // Removes a node by key if it exists
+    // Returns true if a node was deleted, false otherwise
+    // (if oldOut is given it receives the removed value)
+    bool erase(const K &k, V *oldOut = nullptr) {
+        if (!root) return false;
+        root = splay(root, k, comparisons);
+        if (!(k == root->key)) return false;
+        if (oldOut) *oldOut = root->val;
+
+        Node *old = root;
+        if (!root->left) {
+            root = root->right;
+        } else {
+            // k is larger than everything on the left, so splaying it there
+            // brings the left maximum up with an empty right child
+            Node *l = splay(root->left, k, comparisons);
+            l->right = root->right;
+            root = l;
+        }
+        delete old;
+        --count;
+        return true;
+    }
+
+    // ----- Range Apply -----
+    // Applies a function `fn(key, value)` to all nodes with keys in [lo, hi],
+    // in ascending order (until fn returns false, see visitInRange). Does
+    // not restructure the tree.
+    template <typename Fn>
+    void rangeApply(const K &lo, const K &hi, Fn fn) {
+        rangeWalk<Node>(root, lo, hi, fn, comparisons);
+    }
+    template <typename Fn>
+    void rangeApply(const K &lo, const K &hi, Fn fn, int &cmp) const {
+        rangeWalk<const Node>(root, lo, hi, fn, cmp);
+    }
+
+    // ----- In-order Traversal -----
+    // Applies `fn(key, value)` to every node in ascending order (no comparisons counted)
+    template <typename Fn>
+    void forEach(Fn fn) const {
+        std::vector<const Node *> stack;
+        const Node *n = root;
+        while (n || !stack.empty()) {
+            while (n) {
+                stack.push_back(n);
+                n = n->left;
+            }
+            n = stack.back();
+            stack.pop_back();
+            fn(n->key, n->val);
+            n = n->right;
+        }
+    }
+
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    // ----- Shape statistics (same meaning as BST::stats) -----
+    TreeStats stats() const {
+        TreeStats st;
+        double depthSum = 0;
+        std::vector<std::pair<const Node *, int>> stack;
+        if (root) stack.push_back({root, 0});
+        while (!stack.empty()) {
+            auto [n, depth] = stack.back();
+            stack.pop_back();
+            if ((int)st.levelFill.size() <= depth) st.levelFill.resize(depth + 1, 0);
+            ++st.levelFill[depth];
+            ++st.nodes;
+            depthSum += depth;
+            if (n->left) stack.push_back({n->left, depth + 1});
+            if (n->right) stack.push_back({n->right, depth + 1});
+        }
+        st.height = (int)st.levelFill.size();
+        st.maxDepth = st.height - 1;
+        if (st.nodes) st.avgDepth = depthSum / st.nodes;
+        return st;
+    }
+
+    // ----- Resets the comparison counter -----
+    void resetMetrics() { comparisons = 0; }
+
+private:
+    void swapWith(SplayBST &other) noexcept {
+        std::swap(root, other.root);
+        std::swap(count, other.count);
+        std::swap(comparisons, other.comparisons);
+    }
+
+    // ----- Iterative Range Walk -----
+    // In-order walk with an explicit stack, pruned to [lo, hi]
+    // (N is Node or const Node, so const callers only see const values)
+    template <typename N, typename Fn>
+    static void rangeWalk(N *root, const K &lo, const K &hi, Fn &fn, int &cmp) {
+        std::vector<N *> stack;
+        auto pushLeft = [&](N *n) {
+            // descend left only while smaller keys can still be in range
+            while (n) {
+                stack.push_back(n);
+                ++cmp;
+                if (!(lo < n->key)) break;
+                n = n->left;
+            }
+        };
+        pushLeft(root);
+        while (!stack.empty()) {
+            N *n = stack.back();
+            stack.pop_back();
+            ++cmp;
+            if (hi < n->key) break;        // everything after this is larger
+            ++cmp;
+            if (!(n->key < lo) && !visitInRange(fn, n->key, n->val))
+                break;                     // apply function in range (fn may stop the walk)
+            pushLeft(n->right);
+        }
+    }
+
+    // ----- Clear -----
+    // Deletes all nodes without recursion (the tree may be a long chain)
+    void clear() {
+        std::vector<Node *> stack;
+        if (root) stack.push_back(root);
+        while (!stack.empty()) {
+            Node *n = stack.back();
+            stack.pop_back();
+            if (n->left) stack.push_back(n->left);
+            if (n->right) stack.push_back(n->right);
+            delete n;
+        }
+        root = nullptr;
+        count = 0;
+    }
+
+    // ----- Top-down Splay -----
+    // Restructures subtree t so that k (or the last node on its search path)
+    // becomes the root, returning that new root. Nodes passed on the way down
+    // are hung onto a "left tree" (smaller keys) and a "right tree" (larger
+    // keys) which are reattached under the new root at the end.
+    static Node *splay(Node *t, const K &k, int &cmp) {
+        Node *lHead = nullptr, *lTail = nullptr; // nodes known to be < k
+        Node *rHead = nullptr, *rTail = nullptr; // nodes known to be > k
+        for (;;) {
+            ++cmp;
+            if (k == t->key) break;
+            ++cmp;
+            if (k < t->key) {
+                if (!t->left) break;
+                ++cmp;
+                if (k < t->left->key) {
+                    // zig-zig: rotate right before linking
+                    Node *y = t->left;
+                    t->left = y->right;
+                    y->right = t;
+                    t = y;
+                    if (!t->left) break;
+                }
+                // link t into the right tree
+                if (rTail) rTail->left = t; else rHead = t;
+                rTail = t;
+                t = t->left;
+            } else {
+                if (!t->right) break;
+                ++cmp;
+                if (t->right->key < k) {
+                    // zig-zig: rotate left before linking
+                    Node *y = t->right;
+                    t->right = y->left;
+                    y->left = t;
+                    t = y;
+                    if (!t->right) break;
+                }
+                // link t into the left tree
+                if (lTail) lTail->right = t; else lHead = t;
+                lTail = t;
+                t = t->right;
+            }
+        }
+        // Reassemble: t's subtrees go to the ends of the side trees
+        if (lTail) {
+            lTail->right = t->left;
+            t->left = lHead;
+        }
+        if (rTail) {
+            rTail->left = t->right;
+            t->right = rHead;
+        }
+        return t;
+    }
+};
+
+#endif
@@ -0,0 +1,387 @@
+#ifndef TREAP_H
+#define TREAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include "BST.h"
+
+// ================== Treap (randomized BST) ==================
+// BST ordered by key and heap-ordered by a random priority, which keeps the
+// expected depth at O(log n) regardless of insertion order. Same interface
+// as BST<K, V>, plus O(log n) split/join so a key range can be carved out
+// into its own tree (and merged back) without erasing keys one by one.
+// Read-only queries have const overloads with a caller-owned `int &cmp`
+// counter, like BST, so they are safe under a shared lock.
+// K - key type, must support comparison operators (<, ==)
+// V - value type (data stored in each node)
+template <typename K, typename V>
+class Treap {
+    // ----- Internal Node structure -----
+    struct Node {
+        K key;            // key used for ordering
+        V val;            // associated value (payload)
+        uint32_t prio;    // random priority, parent's is always >= children's
+        std::size_t size; // number of nodes in this subtree (gives O(1) counts after split)
+        Node *left;       // pointer to left child (keys smaller than this node)
+        Node *right;      // pointer to right child (keys larger than this node)
+
+        Node(const K &k, const V &v, uint32_t p)
+            : key(k), val(v), prio(p), size(1), left(nullptr), right(nullptr) {}
+    };
+
+    Node *root = nullptr;         // root pointer for the treap
+    uint32_t seed = 2463534242u;  // xorshift state for node priorities
+
+public:
+    static constexpr bool selfAdjusting = false; // lookups never modify the tree
+    static constexpr bool concurrent = false;    // callers must serialize writers
+    static constexpr bool persistent = false;    // updates modify nodes in place
+
+    int comparisons = 0;   // counts number of comparisons made (for performance analysis)
+
+    Treap() = default;
+
+    // ----- Ownership -----
+    Treap(const Treap &) = delete;
+    Treap &operator=(const Treap &) = delete;
+    Treap(Treap &&other) noexcept { swapWith(other); }
+    Treap &operator=(Treap &&other) noexcept {
+        if (this != &other) {
+            clear(root);
+            root = nullptr;
+            swapWith(other);
+        }
+        return *this;
+    }
+
+    // ----- Destructor -----
+    ~Treap() { clear(root); }
+
+    // ----- Insert -----
+    // Returns true if inserted successfully, false if key already exists
+    bool insert(const K &k, const V &v) {
+        if (findNode(root, k, comparisons))
+            return false; // duplicate key not allowed
+        insertRec(root, new Node(k, v, nextPriority()));
+        return true;
+    }
+
+    // ----- Find -----
+    // Returns a pointer to the value associated with the key, or nullptr
+    V *find(const K &k) {
+        Node *n = findNode(root, k, comparisons);
+        return n ? &n->val : nullptr;
+    }
+    const V *find(const K &k, int &cmp) const {
+        const Node *n = findNode(root, k, cmp);
+        return n ? &n->val : nullptr;
+    }
+
+    // ----- Assign -----
+    // Replaces the value stored under k. Returns false if k is not in the treap.
+    bool assign(const K &k, const V &v) {
+        V *p = find(k);
+        if (!p) return false;
+        *p = v;
+        return true;
+    }
+
+    // ----- Erase -----
+    // Returns true if a node was deleted, false otherwise
+    // (if oldOut is given it receives the removed value)
+    bool erase(const K &k, V *oldOut = nullptr) {
+        return eraseRec(root, k, oldOut);
+    }
+
+    // ----- Range Apply -----
+    // Applies `fn(key, value)` to all nodes with keys in [lo, hi] (until fn
+    // returns false, see visitInRange)
+    template <typename Fn>
+    void rangeApply(const K &lo, const K &hi, Fn fn) {
+        rangeRec<Node>(root, lo, hi, fn, comparisons);
+    }
+    template <typename Fn>
+    void rangeApply(const K &lo, const K &hi, Fn fn, int &cmp) const {
+        rangeRec<const Node>(root, lo, hi, fn, cmp);
+    }
+
+    // ----- In-order Traversal -----
+    // Applies `fn(key, value)` to every node in ascending order (no comparisons
+    // counted). The non-const overload lets the caller rewrite values in place.
+    template <typename Fn>
+    void forEach(Fn fn) const {
+        forEachRec<const Node>(root, fn);
+    }
+    template <typename Fn>
+    void forEach(Fn fn) {
+        forEachRec<Node>(root, fn);
+    }
+
+    std::size_t size() const { return sz(root); }
+    bool empty() const { return root == nullptr; }
+
+    // ----- Smallest / largest key (nullptr if empty) -----
+    const K *minKey() const {
+        const Node *n = root;
+        if (!n) return nullptr;
+        while (n->left) n = n->left;
+        return &n->key;
+    }
+    const K *maxKey() const {
+        const Node *n = root;
+        if (!n) return nullptr;
+        while (n->right) n = n->right;
+        return &n->key;
+    }
+
+    // ----- Order statistics (all O(log n) expected) -----
+    // Number of keys strictly smaller than k
+    std::size_t rank(const K &k) {
+        return rankRec(root, k, false, comparisons);
+    }
+    std::size_t rank(const K &k, int &cmp) const {
+        return rankRec(root, k, false, cmp);
+    }
+
+    // Value of the i-th smallest key (0-based), or nullptr if i >= size()
+    V *select(std::size_t i) {
+        Node *n = selectNode(root, i, comparisons);
+        return n ? &n->val : nullptr;
+    }
+    const V *select(std::size_t i, int &cmp) const {
+        const Node *n = selectNode(root, i, cmp);
+        return n ? &n->val : nullptr;
+    }
+
+    // Number of keys in [lo, hi] without visiting them
+    std::size_t countRange(const K &lo, const K &hi) {
+        return countRange(lo, hi, comparisons);
+    }
+    std::size_t countRange(const K &lo, const K &hi, int &cmp) const {
+        if (hi < lo) return 0;
+        return rankRec(root, hi, true, cmp) - rankRec(root, lo, false, cmp);
+    }
+
+    // ----- Split -----
+    // Moves every key >= k out of this treap into `out`, which must be empty.
+    // O(log n) expected: only the nodes on one search path are relinked.
+    void splitAt(const K &k, Treap &out) {
+        Node *l = nullptr, *r = nullptr;
+        splitRec(root, k, l, r);
+        root = l;
+        clear(out.root);
+        out.root = r;
+    }
+
+    // ----- Join -----
+    // Appends all of `other` to this treap and leaves `other` empty. Every key
+    // in `other` must be greater than every key here; returns false and leaves
+    // both trees untouched otherwise. O(log n + log m) expected.
+    bool join(Treap &other) {
+        if (!other.root) return true;
+        if (root) {
+            ++comparisons;
+            if (!(*maxKey() < *other.minKey())) return false;
+        }
+        root = mergeRec(root, other.root);
+        other.root = nullptr;
+        return true;
+    }
+
+    // ----- Shape statistics (same meaning as BST::stats) -----
+    TreeStats stats() const {
+        TreeStats st;
+        double depthSum = 0;
+        statsRec(root, 0, st, depthSum);
+        st.height = (int)st.levelFill.size();
+        st.maxDepth = st.height - 1;
+        if (st.nodes) st.avgDepth = depthSum / st.nodes;
+        return st;
+    }
+
+    // ----- Resets the comparison counter -----
+    void resetMetrics() { comparisons = 0; }
+
+private:
+    static std::size_t sz(const Node *n) { return n ? n->size : 0; }
+
+    // ----- Helper: Recompute subtree size after children changed -----
+    static void pull(Node *n) { n->size = 1 + sz(n->left) + sz(n->right); }
+
+    // ----- Helper: xorshift32 priority generator -----
+    uint32_t nextPriority() {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return seed;
+    }
+
+    void swapWith(Treap &other) noexcept {
+        std::swap(root, other.root);
+        std::swap(seed, other.seed);
+        std::swap(comparisons, other.comparisons);
+    }
+
+    // ----- Helper: Clear (postorder) -----
+    static void clear(Node *n) {
+        if (!n) return;
+        clear(n->left);
+        clear(n->right);
+        delete n;
+    }
+
+    // ----- Recursive Split -----
+    // Splits subtree n into l (keys < k) and r (keys >= k)
+    void splitRec(Node *n, const K &k, Node *&l, Node *&r) {
+        if (!n) {
+            l = r = nullptr;
+            return;
+        }
+        ++comparisons;
+        if (n->key < k) {
+            splitRec(n->right, k, n->right, r);
+            l = n;
+        } else {
+            splitRec(n->left, k, l, n->left);
+            r = n;
+        }
+        pull(n);
+    }
+
+    // ----- Recursive Merge -----
+    // Merges a and b where every key in a is smaller than every key in b
+    static Node *mergeRec(Node *a, Node *b) {
+        if (!a) return b;
+        if (!b) return a;
+        if (a->prio > b->prio) {
+            a->right = mergeRec(a->right, b);
+            pull(a);
+            return a;
+        }
+        b->left = mergeRec(a, b->left);
+        pull(b);
+        return b;
+    }
+
+    // ----- Recursive Insert -----
+    // Descends by key until the new node's priority wins, then splits the
+    // subtree there around the new key (the key is known to be absent)
+    void insertRec(Node *&n, Node *nn) {
+        if (!n || nn->prio > n->prio) {
+            splitRec(n, nn->key, nn->left, nn->right);
+            pull(nn);
+            n = nn;
+            return;
+        }
+        ++comparisons;
+        if (nn->key < n->key)
+            insertRec(n->left, nn);
+        else
+            insertRec(n->right, nn);
+        pull(n);
+    }
+
+    // ----- Recursive Rank -----
+    // Number of keys < k in subtree n (<= k when inclusive)
+    static std::size_t rankRec(const Node *n, const K &k, bool inclusive, int &cmp) {
+        if (!n) return 0;
+        ++cmp;
+        bool goRight = inclusive ? !(k < n->key) : n->key < k;
+        if (goRight)
+            return sz(n->left) + 1 + rankRec(n->right, k, inclusive, cmp);
+        return rankRec(n->left, k, inclusive, cmp);
+    }
+
+    // ----- Select -----
+    // Walks down by subtree sizes to the node holding the i-th smallest key
+    static Node *selectNode(Node *n, std::size_t i, int &cmp) {
+        while (n) {
+            ++cmp;
+            std::size_t leftSize = sz(n->left);
+            if (i < leftSize) {
+                n = n->left;
+            } else if (i == leftSize) {
+                return n;
+            } else {
+                i -= leftSize + 1;
+                n = n->right;
+            }
+        }
+        return nullptr;
+    }
+
+    // ----- Recursive Find -----
+    static Node *findNode(Node *n, const K &k, int &cmp) {
+        if (!n)
+            return nullptr; // base case: not found
+        ++cmp;
+        if (k == n->key)
+            return n; // found it
+        ++cmp;
+        if (k < n->key)
+            return findNode(n->left, k, cmp);  // search left
+        else
+            return findNode(n->right, k, cmp); // search right
+    }
+
+    // ----- Recursive Erase -----
+    // The erased node is replaced by the merge of its two children
+    bool eraseRec(Node *&n, const K &k, V *oldOut) {
+        if (!n) return false;
+        ++comparisons;
+        if (k == n->key) {
+            Node *old = n;
+            if (oldOut) *oldOut = old->val;
+            n = mergeRec(n->left, n->right);
+            delete old;
+            return true;
+        }
+        ++comparisons;
+        bool erased = k < n->key ? eraseRec(n->left, k, oldOut) : eraseRec(n->right, k, oldOut);
+        if (erased) pull(n);
+        return erased;
+    }
+
+    // ----- Recursive Range Traversal -----
+    // (N is Node or const Node, so const callers only see const values)
+    template <typename N, typename Fn>
+    static bool rangeRec(N *n, const K &lo, const K &hi, Fn &fn, int &cmp) {
+        if (!n) return true;
+
+        ++cmp;
+        if (lo < n->key && !rangeRec<N>(n->left, lo, hi, fn, cmp))
+            return false;                           // explore left if possible
+
+        ++cmp;
+        if (!(n->key < lo) && !(hi < n->key) && !visitInRange(fn, n->key, n->val))
+            return false;                           // apply function in range
+
+        ++cmp;
+        if (n->key < hi)
+            return rangeRec<N>(n->right, lo, hi, fn, cmp); // explore right if possible
+        return true;
+    }
+
+    // ----- Helper: In-order Traversal -----
+    template <typename N, typename Fn>
+    static void forEachRec(N *n, Fn &fn) {
+        if (!n) return;
+        forEachRec<N>(n->left, fn);
+        fn(n->key, n->val);
+        forEachRec<N>(n->right, fn);
+    }
+
+    // ----- Helper: Shape Statistics -----
+    static void statsRec(const Node *n, int depth, TreeStats &st, double &depthSum) {
+        if (!n) return;
+        if ((int)st.levelFill.size() <= depth) st.levelFill.resize(depth + 1, 0);
+        ++st.levelFill[depth];
+        ++st.nodes;
+        depthSum += depth;
+        statsRec(n->left, depth + 1, st, depthSum);
+        statsRec(n->right, depth + 1, st, depthSum);
+    }
+};
+
+#endif
@@ -0,0 +1,400 @@
+#ifndef WRITEAHEADLOG_H
+#define WRITEAHEADLOG_H
+
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ================== Log Record Encoding ==================
+// Payload builder/parser for log records: fixed-width values in native byte
+// order and strings as u32 length + bytes.
+class LogRecordWriter {
+    std::vector<char> bytes;
+
+public:
+    void clear() { bytes.clear(); }
+    const char *data() const { return bytes.data(); }
+    size_t size() const { return bytes.size(); }
+
+    template <typename T>
+    void put(const T &v) {
+        static_assert(std::is_trivially_copyable<T>::value, "put() copies raw bytes");
+        const char *p = reinterpret_cast<const char *>(&v);
+        bytes.insert(bytes.end(), p, p + sizeof(T));
+    }
+    void putString(const std::string &s) {
+        put((uint32_t)s.size());
+        bytes.insert(bytes.end(), s.begin(), s.end());
+    }
+};
+
+class LogRecordReader {
+    const char *p;
+    const char *end;
+
+public:
+    LogRecordReader(const char *data, size_t n) : p(data), end(data + n) {}
+
+    // Each getter returns false (and leaves out alone) if the payload is too short
+    template <typename T>
+    bool get(T &out) {
+        if ((size_t)(end - p) < sizeof(T)) return false;
+        std::memcpy(&out, p, sizeof(T));
+        p += sizeof(T);
+        return true;
+    }
+    bool getString(std::string &out) {
+        uint32_t len;
+        if (!get(len) || (size_t)(end - p) < len) return false;
+        out.assign(p, len);
+        p += len;
+        return true;
+    }
+    bool done() const { return p == end; }
+};
+
+// ================== Write-Ahead Log ==================
+// Append-only file of log records, each framed as
+//   u32 payload size, u32 checksum, u64 LSN, u8 kind, payload
+// LSNs (log sequence numbers) count up by one per record. The checksum
+// covers LSN, kind and payload, so a record torn by a crash mid-write is
+// recognized: replay() stops at the first frame that does not check out, and
+// open() cuts such a tail off before appending after it.
+//
+// Group commit: append() only copies the record into an in-memory buffer.
+// commit(lsn) then waits until the record is on disk. The first committer
+// to find no flush in progress becomes the leader: it takes the whole
+// buffer (its own record and everyone else's appended so far), writes it
+// and calls fdatasync once, outside the mutex, while the others wait on a
+// condition variable or keep appending into a fresh buffer for the next
+// round. Under load one fsync therefore covers every writer that arrived
+// during the previous one instead of one fsync per record.
+//
+// A failed write or fsync marks the log failed: later commits return false
+// and nothing more is written, since records after a lost one could not be
+// replayed in order anyway.
+//
+// The file only grows until truncateThrough() drops the records a snapshot
+// already covers from its front (Engine::checkpoint does so once the
+// snapshot is on disk), which keeps it, and replay time, bounded by the
+// writes since the last checkpoint. Scans read the file in fixed-size
+// chunks, so open() and replay() need no memory in proportion to its size.
+class WriteAheadLog {
+    static constexpr size_t kFrameHeader = 4 + 4 + 8 + 1;
+    static constexpr size_t kScanChunk = 1 << 16;   // bytes read at a time by scans
+
+    int fd = -1;
+    std::string filePath;
+    mutable std::mutex m;
+    std::condition_variable flushed;
+    std::vector<char> buffer;     // framed records not yet handed to a flush
+    std::vector<char> spare;      // the previous flush's buffer, reused
+    uint64_t nextLsn = 1;         // LSN of the next append
+    uint64_t durableLsn = 0;      // every record up to here is on disk
+    bool flushing = false;        // a leader is writing and syncing
+    bool failed = false;
+    size_t syncs = 0;             // fdatasync calls made
+
+public:
+    WriteAheadLog() = default;
+    WriteAheadLog(const WriteAheadLog &) = delete;
+    WriteAheadLog &operator=(const WriteAheadLog &) = delete;
+    ~WriteAheadLog() { close(); }
+
+    // ----- Open -----
+    // Opens (or creates) the log at path for appending. A torn record at the
+    // end is truncated away. The next LSN follows the last record in the
+    // file, or afterLsn (the position of a snapshot the log continues) if
+    // that is larger. Returns false if the file cannot be opened.
+    bool open(const std::string &path, uint64_t afterLsn = 0) {
+        close();
+        uint64_t lastLsn = 0;
+        size_t validBytes = 0;
+        auto skip = [](uint64_t, const char *, size_t) {};
+        if (!scanFile(path, lastLsn, validBytes, skip)) return false;
+        int f = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (f < 0) return false;
+        struct stat st;
+        if (::fstat(f, &st) != 0 || ((size_t)st.st_size > validBytes && ::ftruncate(f, (off_t)validBytes) != 0)) {
+            ::close(f);
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(m);
+        fd = f;
+        filePath = path;
+        durableLsn = lastLsn > afterLsn ? lastLsn : afterLsn;
+        nextLsn = durableLsn + 1;
+        failed = false;
+        return true;
+    }
+
+    // Flushes what is buffered and closes the file
+    void close() {
+        if (fd < 0) return;
+        commit(lastLsn());
+        std::lock_guard<std::mutex> lock(m);
+        ::close(fd);
+        fd = -1;
+        buffer.clear();
+    }
+
+    bool isOpen() const {
+        std::lock_guard<std::mutex> lock(m);
+        return fd >= 0;
+    }
+
+    // ----- Append -----
+    // Buffers one record and returns its LSN (0 if the log is not open or
+    // has failed). The record is durable only after commit(LSN).
+    uint64_t append(uint8_t kind, const char *payload, size_t n) {
+        std::lock_guard<std::mutex> lock(m);
+        if (fd < 0 || failed) return 0;
+        uint64_t lsn = nextLsn++;
+        uint32_t size = (uint32_t)n, sum = checksum(lsn, kind, payload, n);
+        size_t at = buffer.size();
+        buffer.resize(at + kFrameHeader + n);
+        char *p = buffer.data() + at;
+        std::memcpy(p, &size, 4);
+        std::memcpy(p + 4, &sum, 4);
+        std::memcpy(p + 8, &lsn, 8);
+        p[16] = (char)kind;
+        if (n) std::memcpy(p + kFrameHeader, payload, n);
+        return lsn;
+    }
+    uint64_t append(uint8_t kind, const LogRecordWriter &record) {
+        return append(kind, record.data(), record.size());
+    }
+
+    // ----- Commit (group commit, see above) -----
+    // Waits until every record up to lsn is on disk. Returns false if the
+    // log failed before that.
+    bool commit(uint64_t lsn) {
+        std::unique_lock<std::mutex> lock(m);
+        while (durableLsn < lsn && !failed && fd >= 0) {
+            if (flushing) {
+                flushed.wait(lock);
+                continue;
+            }
+            // Become the leader for everything buffered so far
+            flushing = true;
+            std::vector<char> batch;
+            batch.swap(spare);
+            batch.swap(buffer);
+            uint64_t upTo = nextLsn - 1;
+            lock.unlock();
+
+            bool ok = writeAll(batch.data(), batch.size()) && ::fdatasync(fd) == 0;
+
+            lock.lock();
+            flushing = false;
+            ++syncs;
+            if (ok) durableLsn = upTo; else failed = true;
+            batch.clear();
+            spare.swap(batch);
+            flushed.notify_all();
+        }
+        return durableLsn >= lsn;
+    }
+
+    // LSN of the last appended record (0 if none yet)
+    uint64_t lastLsn() const {
+        std::lock_guard<std::mutex> lock(m);
+        return nextLsn - 1;
+    }
+    uint64_t durable() const {
+        std::lock_guard<std::mutex> lock(m);
+        return durableLsn;
+    }
+    size_t syncCount() const {
+        std::lock_guard<std::mutex> lock(m);
+        return syncs;
+    }
+    bool hasFailed() const {
+        std::lock_guard<std::mutex> lock(m);
+        return failed;
+    }
+
+    // ----- Truncate -----
+    // Drops the records up to lsn (those a durable snapshot covers) from the
+    // front of the log. The later ones are copied to path.tmp, which is
+    // synced and renamed over the log, so a crash leaves either the old file
+    // or the new one, and the copy becomes the file appends go to. Writers
+    // keep appending during the copy: only the records flushed while it ran
+    // are copied with appends held off. LSNs keep counting, so a log reopened
+    // after this needs the snapshot's position (open(path, lsn)) if no record
+    // is left. Returns false on an I/O error, leaving the log as it was.
+    bool truncateThrough(uint64_t lsn) {
+        std::string path;
+        {
+            std::lock_guard<std::mutex> lock(m);
+            if (fd < 0 || failed) return false;
+            path = filePath;
+        }
+        std::string tmpPath = path + ".tmp";
+        int in = ::open(path.c_str(), O_RDONLY);
+        if (in < 0) return false;
+        int out = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (out < 0) {
+            ::close(in);
+            return false;
+        }
+        bool copied = true;
+        auto copy = [&](uint64_t recordLsn, const char *frame, size_t n) {
+            if (copied && recordLsn > lsn) copied = writeAll(out, frame, n);
+        };
+
+        // 1. The records on disk now, while writers go on
+        uint64_t lastLsn = 0;
+        size_t at = 0;
+        bool ok = scanFd(in, lastLsn, at, copy);
+
+        // 2. Those flushed meanwhile, then the switch, with no flush running
+        std::unique_lock<std::mutex> lock(m);
+        while (flushing) flushed.wait(lock);
+        ok = ok && fd >= 0 && !failed && scanFd(in, lastLsn, at, copy) && copied;
+        ok = ok && ::fdatasync(out) == 0 && ::rename(tmpPath.c_str(), path.c_str()) == 0;
+        if (ok) {
+            ::close(fd);
+            fd = out;
+        }
+        lock.unlock();
+
+        ::close(in);
+        if (!ok) {
+            ::close(out);
+            ::unlink(tmpPath.c_str());
+            return false;
+        }
+        return syncDirectoryOf(path);
+    }
+
+    // ----- Replay -----
+    // Calls `fn(lsn, kind, payload, size)` for every intact record of the log
+    // at path, in LSN order, stopping at a torn or corrupt tail. A missing
+    // file is an empty log. Returns false if the file exists but cannot be read.
+    template <typename Fn>
+    static bool replay(const std::string &path, Fn fn) {
+        uint64_t lastLsn = 0;
+        size_t validBytes = 0;
+        auto record = [&](uint64_t lsn, const char *frame, size_t n) {
+            fn(lsn, (uint8_t)frame[16], frame + kFrameHeader, n - kFrameHeader);
+        };
+        return scanFile(path, lastLsn, validBytes, record);
+    }
+
+private:
+    // FNV-1a over LSN, kind and payload
+    static uint32_t checksum(uint64_t lsn, uint8_t kind, const char *payload, size_t n) {
+        uint32_t h = 2166136261u;
+        auto mix = [&](const void *data, size_t len) {
+            const unsigned char *p = static_cast<const unsigned char *>(data);
+            for (size_t i = 0; i < len; ++i) h = (h ^ p[i]) * 16777619u;
+        };
+        mix(&lsn, sizeof(lsn));
+        mix(&kind, 1);
+        mix(payload, n);
+        return h;
+    }
+
+    bool writeAll(const char *p, size_t n) {
+        return writeAll(fd, p, n);
+    }
+    static bool writeAll(int f, const char *p, size_t n) {
+        while (n > 0) {
+            ssize_t w = ::write(f, p, n);
+            if (w < 0) return false;
+            p += w;
+            n -= (size_t)w;
+        }
+        return true;
+    }
+
+    // Syncs the directory holding path, so a rename into it is durable
+    static bool syncDirectoryOf(const std::string &path) {
+        size_t slash = path.rfind('/');
+        std::string dir = slash == std::string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+        int d = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+        if (d < 0) return false;
+        bool ok = ::fsync(d) == 0;
+        ::close(d);
+        return ok;
+    }
+
+    // Walks the intact prefix of the file: fn(lsn, frame, frame size) per
+    // record, then the last LSN and the byte length of the prefix
+    template <typename Fn>
+    static bool scanFile(const std::string &path, uint64_t &lastLsn, size_t &validBytes, Fn &fn) {
+        int f = ::open(path.c_str(), O_RDONLY);
+        if (f < 0) return errno == ENOENT;
+        validBytes = 0;
+        bool ok = scanFd(f, lastLsn, validBytes, fn);
+        ::close(f);
+        return ok;
+    }
+
+    // Continues a scan of f at byte `at`, after the record lastLsn (0 at the
+    // start of the file), reading kScanChunk bytes at a time (more only for a
+    // record larger than that). Stops at the end of the file or at the first
+    // frame that is torn, out of sequence or fails its checksum, leaving `at`
+    // and lastLsn after the last intact record. Returns false on a read error.
+    template <typename Fn>
+    static bool scanFd(int f, uint64_t &lastLsn, size_t &at, Fn &fn) {
+        struct stat st;
+        if (::fstat(f, &st) != 0) return false;
+        size_t fileSize = (size_t)st.st_size;
+        std::vector<char> buf(kScanChunk);
+        size_t begin = 0, end = 0;   // buf[begin, end) holds the file bytes from `at` on
+        bool ok = true, eof = false;
+
+        // Makes sure buf holds at least `need` bytes from `at` on
+        auto fill = [&](size_t need) {
+            while (ok && !eof && end - begin < need) {
+                std::memmove(buf.data(), buf.data() + begin, end - begin);
+                end -= begin;
+                begin = 0;
+                if (buf.size() < need) buf.resize(need);
+                ssize_t r = ::pread(f, buf.data() + end, buf.size() - end, (off_t)(at + end));
+                if (r < 0) ok = false;
+                else if (r == 0) eof = true;
+                else end += (size_t)r;
+            }
+            return end - begin >= need;
+        };
+
+        while (fill(kFrameHeader)) {
+            const char *p = buf.data() + begin;
+            uint32_t size, sum;
+            uint64_t lsn;
+            std::memcpy(&size, p, 4);
+            std::memcpy(&sum, p + 4, 4);
+            std::memcpy(&lsn, p + 8, 8);
+            size_t frame = kFrameHeader + size;
+            if (at + frame > fileSize) {
+                // Past the end as of the last look: torn, unless the file has grown since
+                if (::fstat(f, &st) != 0) return false;
+                fileSize = (size_t)st.st_size;
+                if (at + frame > fileSize) break;
+            }
+            if (lastLsn != 0 && lsn != lastLsn + 1) break;
+            if (!fill(frame)) break;
+            p = buf.data() + begin;
+            if (checksum(lsn, (uint8_t)p[16], p + kFrameHeader, size) != sum) break;
+            fn(lsn, p, frame);
+            lastLsn = lsn;
+            at += frame;
+            begin += frame;
+        }
+        return ok;
+    }
+};
+
+#endif
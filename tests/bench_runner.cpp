@@ -0,0 +1,412 @@
+// tests/bench_runner.cpp
+// Micro-benchmarks for the index engine. Not part of CI; build with
+//   g++ -std=gnu++17 -O2 -pthread tests/bench_runner.cpp -o tests/run_bench
+// and run ./tests/run_bench > bench_output.txt
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../Engine.h"
+
+// ----- Wall-clock timer -----
+struct Timer {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    double seconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+// ----- Synthetic rows -----
+// IDs are dense and increasing (like an enrollment export); surnames are
+// drawn from a small pool so some postings lists get long.
+static std::vector<Record> makeRows(int n, unsigned seed) {
+    static const char *lastNames[] = {"Smith", "Nguyen", "Patel", "Garcia", "Kim", "Lee",
+                                      "Brown", "Ali", "Lopez", "Chen", "Green", "Young"};
+    static const char *majors[] = {"CS", "Math", "EE", "Bio", "Chem", "Econ"};
+    std::mt19937 rng(seed);
+    std::vector<Record> rows(n);
+    for (int i = 0; i < n; ++i) {
+        Record &r = rows[i];
+        r.id = 1000000 + i;
+        r.last = std::string(lastNames[rng() % 12]) + std::to_string(rng() % 500);
+        r.first = "F" + std::to_string(i);
+        r.major = majors[rng() % 6];
+        r.gpa = (rng() % 401) / 100.0;
+    }
+    return rows;
+}
+
+// ----- Zipf(s) sampler over ranks [0, n) -----
+struct Zipf {
+    std::vector<double> cdf;
+    Zipf(int n, double s) : cdf(n) {
+        double sum = 0;
+        for (int i = 0; i < n; ++i) cdf[i] = (sum += 1.0 / std::pow(i + 1, s));
+        for (double &c : cdf) c /= sum;
+    }
+    int operator()(std::mt19937 &rng) const {
+        double u = std::uniform_real_distribution<double>(0, 1)(rng);
+        return (int)(std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin());
+    }
+};
+
+// ----- Zipfian point lookups: balanced vs splay idIndex -----
+template <typename EngineT>
+static void benchZipfLookups(const char *name, const std::vector<Record> &rows,
+                             const std::vector<int> &trace) {
+    EngineT eng;
+    for (const Record &r : rows) eng.insertRecord(r);
+    long long totalCmp = 0;
+    Timer t;
+    for (int id : trace) {
+        int cmp = 0;
+        eng.findById(id, cmp);
+        totalCmp += cmp;
+    }
+    double secs = t.seconds();
+    std::printf("%-28s %10.1f ns/lookup %8.2f cmp/lookup\n", name,
+                secs * 1e9 / trace.size(), (double)totalCmp / trace.size());
+}
+
+// ----- Ingest: insertRecord per row vs insertBatch -----
+// Rows arrive in shuffled ID order, as from a merged export.
+template <typename EngineT>
+static void benchIngest(const char *name, const std::vector<Record> &rows, size_t batch) {
+    EngineT eng;
+    Timer t;
+    if (batch == 1) {
+        for (const Record &r : rows) eng.insertRecord(r);
+    } else {
+        for (size_t i = 0; i < rows.size(); i += batch)
+            eng.insertBatch(rows.data() + i, std::min(batch, rows.size() - i));
+    }
+    double secs = t.seconds();
+    std::printf("%-28s batch %6zu %10.1f ns/row\n", name, batch, secs * 1e9 / rows.size());
+}
+
+// ----- Batched point lookups: findById loop vs findManyById -----
+template <typename EngineT>
+static void benchFindMany(const char *name, const std::vector<Record> &rows,
+                          const std::vector<int> &ids, size_t batch) {
+    EngineT eng;
+    eng.insertBatch(rows);
+    size_t hits = 0;
+    Timer t;
+    if (batch == 1) {
+        for (int id : ids) {
+            int cmp = 0;
+            hits += eng.findById(id, cmp) != nullptr;
+        }
+    } else {
+        for (size_t i = 0; i < ids.size(); i += batch) {
+            int cmp = 0;
+            for (const Record *r : eng.findManyById(ids.data() + i, std::min(batch, ids.size() - i), cmp))
+                hits += r != nullptr;
+        }
+    }
+    double secs = t.seconds();
+    std::printf("%-28s batch %6zu %10.1f ns/lookup (%zu hits)\n", name, batch, secs * 1e9 / ids.size(), hits);
+}
+
+// ----- Prefix scans over the compressed postings -----
+static void benchPrefixScan(const std::vector<Record> &rows) {
+    Engine eng;
+    eng.insertBatch(rows);
+    EngineStats st = eng.stats();
+    size_t postings = 0;
+    eng.lastIndex.forEach([&](const std::string &, const Postings &p) { postings += p.size(); });
+    Timer t;
+    size_t found = 0;
+    const char *prefixes[] = {"s", "n", "p", "g", "k", "l", "b", "a", "c", "y"};
+    for (int round = 0; round < 20; ++round)
+        for (const char *prefix : prefixes) {
+            int cmp = 0;
+            found += eng.prefixByLast(prefix, cmp).size();
+        }
+    double secs = t.seconds();
+    std::printf("postings: %zu RIDs in %zu bytes (%.2f bytes/RID, at least 4 uncompressed)\n",
+                postings, st.postingsBytes, (double)st.postingsBytes / postings);
+    std::printf("prefixByLast: %.1f ns/row returned (%zu rows)\n", secs * 1e9 / found, found);
+}
+
+// ----- Restart: load a binary snapshot vs re-ingest the rows -----
+static void benchSaveLoad(const std::vector<Record> &rows) {
+    const char *path = "bench_snapshot.bin";
+    Engine src;
+    src.insertBatch(rows);
+    Timer ts;
+    src.save(path);
+    double saveSecs = ts.seconds();
+
+    Timer tl;
+    Engine loaded;
+    loaded.load(path);
+    double loadSecs = tl.seconds();
+
+    Timer ti;
+    Engine rebuilt;
+    rebuilt.insertBatch(rows);
+    double ingestSecs = ti.seconds();
+    std::remove(path);
+    std::printf("save %.3f s, load %.3f s, re-ingest with insertBatch %.3f s (%zu rows)\n",
+                saveSecs, loadSecs, ingestSecs, loaded.stats().liveRows);
+}
+
+// ----- Mapped store: open time and point lookups vs the in-memory engine -----
+static void benchMappedStore(const std::vector<Record> &rows, const std::vector<int> &ids) {
+    const char *path = "bench_heap.bin";
+    Engine eng;
+    eng.insertBatch(rows);
+    eng.exportMapped(path);
+
+    Timer to;
+    MappedRecordStore store;
+    store.open(path);
+    double openSecs = to.seconds();
+
+    size_t hits = 0;
+    Timer te;
+    for (int id : ids) {
+        int cmp = 0;
+        hits += eng.findById(id, cmp) != nullptr;
+    }
+    double engineSecs = te.seconds();
+    Timer tm;
+    for (int id : ids) {
+        int cmp = 0;
+        hits += store.findById(id, cmp).has_value();
+    }
+    double mappedSecs = tm.seconds();
+    std::remove(path);
+    std::printf("open %.1f us; findById %.1f ns/lookup (engine) vs %.1f ns/lookup (mapped), %zu hits\n",
+                openSecs * 1e6, engineSecs * 1e9 / ids.size(), mappedSecs * 1e9 / ids.size(), hits);
+}
+
+// ----- Durable inserts: one fsync per write vs group commit -----
+static void benchWal(int threads, int perThread) {
+    const char *path = "bench_wal.log";
+    std::remove(path);
+    ConcurrentEngine eng;
+    WriteAheadLog log;
+    log.open(path);
+    eng.attachLog(&log);
+    Timer t;
+    std::vector<std::thread> writers;
+    for (int w = 0; w < threads; ++w) {
+        writers.emplace_back([&, w] {
+            for (int i = 0; i < perThread; ++i)
+                eng.insertRecord({1000000 + i * threads + w, "Durable", "D", "CS", 2.0, false});
+        });
+    }
+    for (auto &th : writers) th.join();
+    double secs = t.seconds();
+    eng.attachLog(nullptr);
+    size_t writes = (size_t)threads * perThread;
+    std::printf("%2d writer(s): %9.0f durable writes/s, %.3f fsyncs per write\n", threads, writes / secs,
+                (double)log.syncCount() / writes);
+    log.close();
+    std::remove(path);
+}
+
+// ----- Writer stalls: save() vs checkpoint() on a loaded engine -----
+// A writer inserts in a loop while the image is taken; the longest single
+// insert shows how long writers were held up.
+static void benchCheckpoint(const std::vector<Record> &rows) {
+    const char *path = "bench_ckpt.bin";
+    for (int useCheckpoint = 0; useCheckpoint < 2; ++useCheckpoint) {
+        Engine eng;
+        eng.insertBatch(rows);
+        std::atomic<bool> done{false};
+        double worst = 0;
+        size_t writes = 0;
+        std::thread writer([&] {
+            for (int id = 50000000; !done.load(); ++id, ++writes) {
+                Timer t;
+                eng.insertRecord({id, "Writer", "W", "CS", 2.0, false});
+                worst = std::max(worst, t.seconds());
+            }
+        });
+        Timer t;
+        if (useCheckpoint) eng.checkpoint(path); else eng.save(path);
+        double secs = t.seconds();
+        done = true;
+        writer.join();
+        std::remove(path);
+        std::printf("%-10s %.3f s, %zu concurrent inserts, longest insert %.2f ms\n",
+                    useCheckpoint ? "checkpoint" : "save", secs, writes, worst * 1e3);
+    }
+}
+
+// ----- CSV import: parse throughput and importCsv vs getline + insertRecord -----
+static void benchCsvImport(const std::vector<Record> &rows) {
+    const char *path = "bench_import.csv";
+    {
+        std::FILE *f = std::fopen(path, "wb");
+        std::fputs("id,last,first,major,gpa\n", f);
+        for (const Record &r : rows)
+            std::fprintf(f, "%d,%s,%s,%s,%.2f\n", r.id, r.last.c_str(), r.first.c_str(), r.major.c_str(), r.gpa);
+        std::fclose(f);
+    }
+
+    std::vector<Record> parsed;
+    CsvImportStats st;
+    Timer tp;
+    CsvImporter::readFile(path, parsed, st);
+    double parseSecs = tp.seconds();
+
+    Timer ti;
+    Engine eng;
+    eng.importCsv(path, st);
+    double importSecs = ti.seconds();
+
+    Timer tn;
+    Engine naive;
+    std::ifstream in(path);
+    std::string line, field;
+    std::getline(in, line);   // header
+    while (std::getline(in, line)) {
+        std::stringstream ss(line);
+        Record r;
+        std::getline(ss, field, ',');
+        r.id = std::stoi(field);
+        std::getline(ss, r.last, ',');
+        std::getline(ss, r.first, ',');
+        std::getline(ss, r.major, ',');
+        std::getline(ss, field, ',');
+        r.gpa = std::stod(field);
+        naive.insertRecord(r);
+    }
+    double naiveSecs = tn.seconds();
+    std::remove(path);
+    double mb = st.bytes / 1e6;
+    std::printf("%.1f MB, %zu rows: parse %.0f MB/s; importCsv %.3f s (%.0f MB/s); getline + insertRecord %.3f s\n",
+                mb, st.inserted, mb / parseSecs, importSecs, mb / importSecs, naiveSecs);
+}
+
+// ----- Export: rangeById + fprintf vs streaming into CsvSink / ColumnarWriter -----
+static void benchExport(const std::vector<Record> &rows) {
+    const char *path = "bench_export.out";
+    Engine eng;
+    eng.insertBatch(rows);
+    int cmp = 0;
+
+    Timer tv;
+    std::vector<const Record *> found = eng.rangeById(INT_MIN, INT_MAX, cmp);
+    std::FILE *f = std::fopen(path, "wb");
+    for (const Record *r : found)
+        std::fprintf(f, "%d,%s,%s,%s,%g\n", r->id, r->last.c_str(), r->first.c_str(), r->major.c_str(), r->gpa);
+    std::fclose(f);
+    double vectorSecs = tv.seconds();
+
+    Timer tc;
+    CsvSink csv(path);
+    size_t n = eng.exportRangeById(INT_MIN, INT_MAX, csv);
+    csv.finish();
+    double csvSecs = tc.seconds();
+
+    Timer tb;
+    ColumnarWriter col(path);
+    eng.exportRangeById(INT_MIN, INT_MAX, col);
+    col.finish();
+    double colSecs = tb.seconds();
+    std::remove(path);
+    std::printf("%zu rows: rangeById + fprintf %.3f s (%.1f MB of pointers); CsvSink %.3f s; ColumnarWriter %.3f s\n",
+                n, vectorSecs, found.size() * sizeof(void *) / 1e6, csvSecs, colSecs);
+}
+
+// ----- Columnar archive: full scan vs zone-map-pruned scans -----
+static void benchColumnar(const std::vector<Record> &rows) {
+    const char *path = "bench_archive.col";
+    Engine eng;
+    eng.insertBatch(rows);
+    Timer tw;
+    eng.saveColumnar(path);
+    double writeSecs = tw.seconds();
+
+    auto run = [&](const char *label, const ColumnarPredicate &pred) {
+        double gpaSum = 0;
+        Timer t;
+        ColumnarScanStats st = Engine::scanColumnar(path, pred, [&](const RecordView &v) { gpaSum += v.gpa; });
+        std::printf("  %-18s %8.2f ms, %8zu rows, %zu/%zu blocks skipped (checksum %.0f)\n", label,
+                    t.seconds() * 1e3, st.rows, st.skippedByZoneMap + st.skippedByDictionary, st.blocks, gpaSum);
+    };
+    std::printf("saveColumnar %.3f s\n", writeSecs);
+    ColumnarPredicate all, range, honors, major;
+    range.minId = 1000000 + (int)rows.size() / 2;
+    range.maxId = range.minId + 9999;
+    honors.minGpa = 3.9;
+    major.major = "Chem";
+    run("full scan", all);
+    run("10K-id range", range);
+    run("gpa >= 3.9", honors);
+    run("major = Chem", major);
+    std::remove(path);
+}
+
+int main() {
+    const int n = 200000;
+    std::vector<Record> rows = makeRows(n, 7);
+
+    // Zipf(1.0) over a random permutation of IDs so hot keys are scattered
+    std::mt19937 rng(11);
+    std::vector<int> perm(n);
+    for (int i = 0; i < n; ++i) perm[i] = rows[i].id;
+    std::shuffle(perm.begin(), perm.end(), rng);
+    Zipf zipf(n, 1.0);
+    std::vector<int> trace(1000000);
+    for (int &id : trace) id = perm[zipf(rng)];
+
+    std::printf("== Zipfian findById (n=%d, %zu lookups) ==\n", n, trace.size());
+    benchZipfLookups<Engine>("Engine (scapegoat BST)", rows, trace);
+    benchZipfLookups<SplayEngine>("SplayEngine (splay tree)", rows, trace);
+
+    std::vector<Record> shuffled = rows;
+    std::shuffle(shuffled.begin(), shuffled.end(), rng);
+    std::printf("\n== Ingest (n=%d, shuffled IDs) ==\n", n);
+    for (size_t batch : {(size_t)1, (size_t)10000, (size_t)100000}) {
+        benchIngest<Engine>("Engine (scapegoat BST)", shuffled, batch);
+        benchIngest<ConcurrentEngine>("ConcurrentEngine (B+tree)", shuffled, batch);
+    }
+
+    // Uniform IDs over a table much larger than the caches
+    const int big = 2000000;
+    std::vector<Record> bigRows = makeRows(big, 13);
+    std::vector<int> ids(1000000);
+    for (int &id : ids) id = 1000000 + (int)(rng() % big);
+    std::printf("\n== Uniform findById vs findManyById (n=%d, %zu lookups) ==\n", big, ids.size());
+    for (size_t batch : {(size_t)1, (size_t)256})
+        benchFindMany<Engine>("Engine (scapegoat BST)", bigRows, ids, batch);
+
+    std::printf("\n== Compressed postings (n=%d) ==\n", n);
+    benchPrefixScan(rows);
+
+    std::printf("\n== Snapshot save/load (n=%d) ==\n", big);
+    benchSaveLoad(bigRows);
+
+    std::printf("\n== Mapped record store (n=%d, %zu lookups) ==\n", big, ids.size());
+    benchMappedStore(bigRows, ids);
+
+    std::printf("\n== Checkpoint vs save while a writer runs (n=%d) ==\n", big);
+    benchCheckpoint(bigRows);
+
+    std::printf("\n== CSV import (n=%d) ==\n", big);
+    benchCsvImport(bigRows);
+
+    std::printf("\n== Streaming export (n=%d) ==\n", big);
+    benchExport(bigRows);
+
+    std::printf("\n== Columnar archive scans (n=%d) ==\n", big);
+    benchColumnar(bigRows);
+
+    std::printf("\n== Write-ahead log with group commit ==\n");
+    for (int threads : {1, 8, 32}) benchWal(threads, 32000 / threads);
+    return 0;
+}
@@ -1,8 +1,19 @@
 // tests/test_runner.cpp
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 #include <vector>
 #include <string>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <random>
+#include <set>
+#include <thread>
+#include <atomic>
+#include <memory>
 #include "../BST.h"
 #include "../Record.h"
 #include "../Engine.h"  
@@ -140,5 +151,1615 @@ int main() {
         ts.check_eq_int(cmp, 9, "comparisons for prefixByLast('SMI') after insert");
     }
 
+    // --- Test: index and row statistics ---
+    {
+        EngineStats st = eng.stats();
+        ts.check_eq_int((int)st.liveRows, 7, "stats liveRows after 8 inserts and 1 delete");
+        ts.check_eq_int((int)st.tombstonedRows, 1, "stats tombstonedRows");
+        // Sorted IDs -> idIndex is a 7-node chain
+        ts.check_eq_int((int)st.idTree.nodes, 7, "stats idTree nodes");
+        ts.check_eq_int(st.idTree.height, 7, "stats idTree height (right-skewed chain)");
+        ts.check(st.idTree.avgDepth == 3.0, "stats idTree avgDepth of 7-chain is 3");
+        ts.check_eq_int((int)st.distinctLastNames, 6, "stats distinct last names");
+        ts.check_eq_int((int)st.maxPostings, 2, "stats longest postings list (smith)");
+        ts.check(st.postingsLog2.size() == 2 && st.postingsLog2[0] == 5 && st.postingsLog2[1] == 1,
+                 "stats postings length distribution");
+
+        auto hist = eng.idIndex.histogram({1000000, 1001000, 1010000});
+        ts.check(hist.size() == 2 && hist[0] == 3 && hist[1] == 4, "idIndex key-range histogram");
+    }
+
+    // --- Test: scapegoat rebuild keeps sorted inserts logarithmic ---
+    {
+        BST<int, int> t;
+        for (int i = 0; i < 4096; ++i) t.insert(i, i * 2);
+        TreeStats st = t.stats();
+        // log_{4/3}(4096) ~ 28.9 -> no node deeper than 28
+        ts.check(st.maxDepth <= 28, "sorted inserts stay within the scapegoat depth bound");
+        ts.check(t.rebuilds() > 0, "sorted inserts triggered scapegoat rebuilds");
+
+        bool allFound = true;
+        for (int i = 0; i < 4096; ++i) {
+            int *v = t.find(i);
+            if (!v || *v != i * 2) allFound = false;
+        }
+        ts.check(allFound, "all keys findable after rebuilds");
+
+        for (int i = 0; i < 4096; i += 2) t.erase(i);
+        int prev = -1, seen = 0;
+        bool ordered = true;
+        t.forEach([&](const int &k, const int &) { if (k <= prev) ordered = false; prev = k; ++seen; });
+        ts.check(ordered && seen == 2048 && (int)t.size() == 2048, "erase keeps order and size after rebuilds");
+        ts.check(t.stats().maxDepth <= 27, "erase-triggered rebuild keeps tree shallow");
+    }
+
+    // --- Test: BST::shape keeps height and depth up to date without a walk ---
+    {
+        std::mt19937 rng(26);
+        bool ok = true;
+        for (double alpha : {0.75, 1.0}) {
+            BST<int, int> t;
+            t.setBalanceFactor(alpha);
+            auto agrees = [&] {
+                TreeStats fast = t.shape(), full = t.stats();
+                double depthSum = 0;
+                size_t nodes = 0;
+                for (size_t d = 0; d < full.levelFill.size(); ++d) {
+                    depthSum += (double)d * full.levelFill[d];
+                    nodes += full.levelFill[d];
+                }
+                return fast.levelFill.empty() && fast.nodes == nodes &&
+                       fast.height == (int)full.levelFill.size() && fast.maxDepth == fast.height - 1 &&
+                       (nodes == 0 ? fast.avgDepth == 0.0 : std::abs(fast.avgDepth - depthSum / nodes) < 1e-9);
+            };
+            for (int i = 0; i < 3000; ++i) {
+                int k = (int)(rng() % 5000);
+                if (rng() % 3 == 0) t.erase(k); else t.insert(k, i);
+                if (i % 97 == 0) ok = ok && agrees();
+            }
+            std::vector<std::pair<int, int>> batch;
+            for (int i = 0; i < 500; ++i) batch.push_back({6000 + i, i});
+            std::vector<char> inserted;
+            t.insertSorted(batch, inserted);
+            ok = ok && agrees();
+            for (int k = 0; k < 7000; ++k) t.erase(k);
+            ok = ok && agrees() && t.shape().height == 0;
+        }
+        ts.check(ok, "BST::shape agrees with a full walk after inserts, erases and rebuilds");
+    }
+
+    // --- Test: splay-mode engine moves hot keys to the root ---
+    {
+        SplayEngine se;
+        for (const auto& r : seed) se.insertRecord(r);
+        int cold = 0, hot = 0;
+        auto rec = se.findById(1000456, cold);
+        ts.check(rec && rec->last == "Patel", "SplayEngine findById returns correct record");
+        se.findById(1000456, hot);
+        ts.check_eq_int(hot, 1, "repeated splay lookup hits the root with 1 comparison");
+        ts.check(cold > hot, "first splay lookup costs more than the repeat");
+
+        int cmp = 0;
+        auto rows = se.rangeById(1000400, 1001000, cmp);
+        ts.check((int)rows.size() == 3, "SplayEngine rangeById returns 3 rows");
+        ts.check(se.deleteById(1000456) && !se.findById(1000456, cmp), "SplayEngine delete");
+    }
+
+    // --- Test: splay tree agrees with std::map under random operations ---
+    {
+        SplayBST<int, int> t;
+        std::map<int, int> ref;
+        std::mt19937 rng(42);
+        bool agree = true;
+        for (int i = 0; i < 20000; ++i) {
+            int k = (int)(rng() % 2000);
+            switch (rng() % 3) {
+            case 0: agree &= t.insert(k, i) == ref.emplace(k, i).second; break;
+            case 1: agree &= t.erase(k) == (ref.erase(k) == 1); break;
+            default: {
+                int *v = t.find(k);
+                auto it = ref.find(k);
+                agree &= (v == nullptr) == (it == ref.end()) && (!v || *v == it->second);
+            }
+            }
+        }
+        std::vector<int> keys;
+        t.rangeApply(500, 1500, [&](const int &k, const int &) { keys.push_back(k); });
+        std::vector<int> refKeys;
+        for (auto it = ref.lower_bound(500); it != ref.end() && it->first <= 1500; ++it) refKeys.push_back(it->first);
+        ts.check(agree && keys == refKeys && t.size() == ref.size(), "SplayBST matches std::map");
+    }
+
+    // --- Test: treap engine detaches and re-attaches an ID range ---
+    {
+        TreapEngine te;
+        for (const auto& r : seed) te.insertRecord(r);
+        TreapEngine cohort = te.detachById(1000400, 1001000); // 1000456, 1000789, 1000811
+
+        int cmp = 0;
+        ts.check_eq_int((int)cohort.idIndex.size(), 3, "detachById moves 3 ids");
+        ts.check(te.findById(1000789, cmp) == nullptr, "detached id no longer in source engine");
+        auto rec = cohort.findById(1000789, cmp);
+        ts.check(rec && rec->last == "Gonzalez", "detached engine finds moved row");
+        ts.check_eq_int((int)te.rangeById(0, INT_MAX, cmp).size(), 4, "source keeps 4 rows");
+        ts.check_eq_int((int)te.prefixByLast("smith", cmp).size(), 1, "source lastIndex unlinked detached Smith");
+        ts.check_eq_int((int)cohort.prefixByLast("smith", cmp).size(), 1, "detached lastIndex has its Smith");
+
+        TreapEngine overlap;
+        overlap.insertRecord({1001050, "Kim", "Sam", "CS", 3.1, false}); // between 1001022 and 1001099
+        overlap.insertRecord({1002000, "Lee", "Max", "CS", 3.2, false});
+        ts.check(!te.attach(overlap), "attach rejects an id range that interleaves");
+
+        ts.check(te.attach(cohort), "attach merges detached range back");
+        ts.check(cohort.idIndex.empty() && cohort.heap.empty(), "attach empties the other engine");
+        ts.check_eq_int((int)te.rangeById(0, INT_MAX, cmp).size(), 7, "all 7 rows visible after attach");
+        ts.check_eq_int((int)te.prefixByLast("smith", cmp).size(), 2, "both Smiths back after attach");
+    }
+
+    // --- Test: detachById while a read view holds deleted versions ---
+    {
+        TreapEngine te;
+        const int chunk = (int)RecordHeap::kChunkSize, half = chunk / 2;
+        for (int i = 0; i < chunk + 10; ++i)
+            te.insertRecord({8300000 + i, "Detach", "D", "CS", 3.0, false});
+        int cmp = 0;
+        {
+            auto view = te.beginRead();
+            for (int i = 0; i < half; ++i) te.deleteById(8300000 + i);
+            TreapEngine cohort = te.detachById(8300000, 8300000 + half);   // half deleted ids plus one live one
+            ts.check(cohort.idIndex.size() == 1 && cohort.liveRows == 1 && cohort.findById(8300000 + half, cmp),
+                     "detach under a view moves only live rows");
+            ts.check(!view.findById(8300000 + 3, cmp), "view stops seeing detached ids");
+        }
+        ts.check_eq_int((int)te.stats().deadVersions, 0, "detached dead versions leave the collect queue");
+        for (int i = half + 1; i < chunk; ++i) te.deleteById(8300000 + i);
+        ts.check_eq_int((int)te.compact(), chunk, "every row of the chunk retired exactly once");
+        ts.check_eq_int((int)te.rangeById(0, INT_MAX, cmp).size(), 10, "rows past the chunk survive");
+    }
+
+    // --- Test: treap agrees with std::map under random operations, split and join ---
+    {
+        Treap<int, int> t;
+        std::map<int, int> ref;
+        std::mt19937 rng(7);
+        bool agree = true;
+        for (int i = 0; i < 20000; ++i) {
+            int k = (int)(rng() % 2000);
+            switch (rng() % 3) {
+            case 0: agree &= t.insert(k, i) == ref.emplace(k, i).second; break;
+            case 1: agree &= t.erase(k) == (ref.erase(k) == 1); break;
+            default: {
+                int *v = t.find(k);
+                auto it = ref.find(k);
+                agree &= (v == nullptr) == (it == ref.end()) && (!v || *v == it->second);
+            }
+            }
+        }
+        Treap<int, int> upper;
+        t.splitAt(1000, upper);
+        size_t below = 0;
+        for (auto &kv : ref) below += kv.first < 1000;
+        agree &= t.size() == below && upper.size() == ref.size() - below;
+        agree &= !upper.join(t);   // wrong order must be rejected
+        agree &= t.join(upper) && upper.empty() && t.size() == ref.size();
+        std::vector<int> keys, refKeys;
+        t.forEach([&](const int &k, const int &) { keys.push_back(k); });
+        for (auto &kv : ref) refKeys.push_back(kv.first);
+        ts.check(agree && keys == refKeys, "Treap matches std::map across split/join");
+        ts.check(t.stats().maxDepth < 40, "Treap depth stays logarithmic");
+    }
+
+    // --- Test: order statistics (countById / rankById / selectById) ---
+    {
+        int cmp = 0;
+        // eng holds 1000123, 1000456, 1000789, 1001022, 1001099, 1002042, 1003000
+        ts.check_eq_int((int)eng.countById(1000400, 1001000, cmp), 2, "countById skips deleted 1000811");
+        ts.check_eq_int((int)eng.countById(0, INT_MAX, cmp), 7, "countById over whole key space");
+        ts.check_eq_int((int)eng.countById(1001022, 1001022, cmp), 1, "countById single key");
+        ts.check_eq_int((int)eng.rankById(1001022, cmp), 3, "rankById counts smaller ids");
+        auto rec = eng.selectById(4, cmp);
+        ts.check(rec && rec->id == 1001099, "selectById(4) returns 5th id");
+        ts.check(eng.selectById(7, cmp) == nullptr, "selectById out of range");
+
+        BST<int, int> t;
+        std::mt19937 rng(3);
+        std::map<int, int> ref;
+        for (int i = 0; i < 5000; ++i) {
+            int k = (int)(rng() % 10000);
+            if (rng() % 4 == 0) { t.erase(k); ref.erase(k); }
+            else { t.insert(k, k); ref.emplace(k, k); }
+        }
+        bool ok = t.size() == ref.size();
+        size_t i = 0;
+        for (auto &kv : ref) {
+            ok &= t.rank(kv.first) == i;
+            const int *key = t.selectKey(i);
+            ok &= key && *key == kv.first;
+            ++i;
+        }
+        size_t refCount = 0;
+        for (auto it = ref.lower_bound(2500); it != ref.end() && it->first <= 7500; ++it) ++refCount;
+        ok &= t.countRange(2500, 7500) == refCount;
+        ts.check(ok, "BST rank/select/countRange agree with std::map");
+    }
+
+    // --- Test: GPA range aggregates from subtree summaries ---
+    {
+        int cmp = 0;
+        // live: 1000123 3.87, 1000456 3.55, 1000789 3.92, 1001022 3.20,
+        //       1001099 3.70, 1002042 3.65, 1003000 3.80
+        auto agg = eng.gpaStatsById(1000400, 1001100, cmp);
+        ts.check_eq_int((int)agg.count, 4, "gpaStatsById count skips deleted row");
+        ts.check(std::abs(agg.sum - (3.55 + 3.92 + 3.20 + 3.70)) < 1e-9, "gpaStatsById sum");
+        ts.check(agg.min == 3.20 && agg.max == 3.92, "gpaStatsById min/max");
+        ts.check(std::abs(eng.avgGpaById(0, INT_MAX, cmp) - 25.69 / 7) < 1e-9, "avgGpaById over all rows");
+        ts.check(eng.avgGpaById(5000000, 6000000, cmp) == 0.0, "avgGpaById of empty range");
+
+        // Randomized: aggregateRange vs brute force, across erases and rebuilds
+        BST<int, IdEntry, GpaSummary> t;
+        std::map<int, double> ref;
+        std::mt19937 rng(5);
+        for (int i = 0; i < 4000; ++i) {
+            int k = (int)(rng() % 3000);
+            double g = (rng() % 401) / 100.0;
+            if (rng() % 3 == 0) { t.erase(k); ref.erase(k); }
+            else if (ref.emplace(k, g).second) t.insert(k, IdEntry{i, g});
+        }
+        bool ok = true;
+        for (int q = 0; q < 200; ++q) {
+            int lo = (int)(rng() % 3000), hi = lo + (int)(rng() % 800);
+            size_t n = 0;
+            double sum = 0, mx = -1;
+            for (auto it = ref.lower_bound(lo); it != ref.end() && it->first <= hi; ++it) {
+                ++n; sum += it->second; mx = std::max(mx, it->second);
+            }
+            auto a = t.aggregateRange(lo, hi);
+            ok &= a.count == n && std::abs(a.sum - sum) < 1e-6 && (n == 0 || a.max == mx);
+        }
+        ts.check(ok, "BST aggregateRange matches brute force");
+    }
+
+    // --- Test: concurrent readers with a writer ---
+    {
+        Engine ce;
+        for (int i = 0; i < 1000; ++i)
+            ce.insertRecord({2000000 + i, "Reader" + std::to_string(i % 37), "R", "CS", (i % 400) / 100.0, false});
+
+        std::atomic<bool> done{false};
+        std::atomic<int> badReads{0};
+        std::vector<std::thread> readers;
+        for (int t = 0; t < 4; ++t) {
+            readers.emplace_back([&, t] {
+                std::mt19937 rng(t);
+                while (!done.load()) {
+                    int id = 2000000 + (int)(rng() % 4000), cmp = 0;
+                    const Record *r = ce.findById(id, cmp);
+                    if (r && r->id != id) ++badReads;
+                    for (const Record *row : ce.rangeById(id, id + 20, cmp))
+                        if (row->id < id || row->id > id + 20) ++badReads;
+                    ce.countById(id, id + 100, cmp);
+                    ce.prefixByLast("reader1", cmp);
+                }
+            });
+        }
+        for (int i = 1000; i < 3000; ++i)
+            ce.insertRecord({2000000 + i, "Writer", "W", "EE", 3.0, false});
+        for (int i = 0; i < 500; ++i)
+            ce.deleteById(2000000 + i * 2);
+        done = true;
+        for (auto &th : readers) th.join();
+
+        int cmp = 0;
+        ts.check(badReads.load() == 0, "concurrent readers only see matching rows");
+        ts.check_eq_int((int)ce.countById(0, INT_MAX, cmp), 2500, "row count after concurrent writes");
+        ts.check_eq_int((int)ce.stats().liveRows, 2500, "liveRows after concurrent writes");
+    }
+
+    // --- Test: OLCBTree matches std::map (splits, erases, ranges) ---
+    {
+        OLCBTree<int, int> t;
+        std::map<int, int> ref;
+        std::mt19937 rng(33);
+        bool ok = true;
+        for (int step = 0; step < 20000; ++step) {
+            int k = (int)(rng() % 5000);
+            if (rng() % 3) {
+                ok &= t.insert(k, k * 7) == ref.emplace(k, k * 7).second;
+            } else {
+                int old = -1;
+                bool erased = t.erase(k, &old);
+                ok &= erased == (ref.erase(k) == 1) && (!erased || old == k * 7);
+            }
+        }
+        for (int k = 0; k < 5000; ++k) {
+            auto v = t.find(k);
+            ok &= v.has_value() == (ref.count(k) == 1) && (!v || *v == k * 7);
+        }
+        std::vector<int> got, want;
+        t.rangeApply(1200, 3400, [&](const int &k, const int &) { got.push_back(k); });
+        for (auto it = ref.lower_bound(1200); it != ref.end() && it->first <= 3400; ++it)
+            want.push_back(it->first);
+        ts.check(ok && got == want && t.size() == ref.size(), "OLCBTree matches std::map");
+    }
+
+    // --- Test: parallel ingest into ConcurrentEngine ---
+    {
+        ConcurrentEngine ce;
+        const int threads = 6, perThread = 3000;
+        std::atomic<bool> done{false};
+        std::atomic<int> badReads{0};
+        std::thread reader([&] {
+            std::mt19937 rng(5);
+            while (!done.load()) {
+                int id = 3000000 + (int)(rng() % (threads * perThread)), cmp = 0;
+                const Record *r = ce.findById(id, cmp);
+                if (r && r->id != id) ++badReads;
+                for (const Record *row : ce.rangeById(id, id + 50, cmp))
+                    if (row->id < id || row->id > id + 50) ++badReads;
+            }
+        });
+        std::vector<std::thread> writers;
+        for (int t = 0; t < threads; ++t) {
+            writers.emplace_back([&, t] {
+                for (int i = 0; i < perThread; ++i) {
+                    int id = 3000000 + i * threads + t;   // interleaved, disjoint per thread
+                    ce.insertRecord({id, "Ingest" + std::to_string(t), "I", "CS", 2.0, false});
+                }
+                for (int i = 0; i < perThread; i += 3)
+                    ce.deleteById(3000000 + i * threads + t);
+            });
+        }
+        for (auto &th : writers) th.join();
+        done = true;
+        reader.join();
+
+        int cmp = 0, missing = 0;
+        for (int i = 0; i < threads * perThread; ++i) {
+            bool live = (i / threads) % 3 != 0;
+            if ((ce.findById(3000000 + i, cmp) != nullptr) != live) ++missing;
+        }
+        size_t expected = threads * (perThread - perThread / 3);
+        ts.check(badReads.load() == 0, "ConcurrentEngine readers only see matching rows");
+        ts.check_eq_int(missing, 0, "ConcurrentEngine membership after parallel ingest");
+        ts.check_eq_int((int)ce.stats().liveRows, (int)expected, "ConcurrentEngine liveRows");
+        ts.check_eq_int((int)ce.prefixByLast("ingest3", cmp).size(), (int)(expected / threads),
+                        "ConcurrentEngine postings after parallel ingest");
+        ts.check_eq_int(ce.insertRecord({3000007, "Dup", "D", "CS", 1.0, false}), -1,
+                        "ConcurrentEngine rejects duplicate IDs");
+    }
+
+    // --- Test: lock-free skip list stress (racing inserts/erases, epoch reclamation) ---
+    {
+        SkipList<int, int> sl;
+        const int threads = 6, keys = 4000;
+        std::atomic<int> badReads{0};
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                std::mt19937 rng(100 + t);
+                // every thread inserts and erases the same keys, so ops collide
+                for (int step = 0; step < 20000; ++step) {
+                    int k = (int)(rng() % keys);
+                    if (rng() % 2) sl.insert(k, k * 3);
+                    else sl.erase(k);
+                    auto v = sl.find((int)(rng() % keys));
+                    if (v && *v % 3 != 0) ++badReads;
+                }
+                // then race to erase every key
+                for (int k = 0; k < keys; ++k) {
+                    int old = -1;
+                    if (sl.erase(k, &old) && old != k * 3) ++badReads;
+                }
+            });
+        }
+        for (auto &th : workers) th.join();
+        int leftover = 0;
+        sl.forEach([&](const int &, const int &) { ++leftover; });
+        ts.check(badReads.load() == 0, "SkipList readers only see inserted values");
+        ts.check_eq_int(leftover + (int)sl.size(), 0, "SkipList empty after racing erases");
+
+        // refill, then make sure range scans agree with std::map
+        std::map<int, int> ref;
+        std::mt19937 rng(9);
+        bool ok = true;
+        for (int i = 0; i < 3000; ++i) {
+            int k = (int)(rng() % 10000);
+            ok &= sl.insert(k, k * 3) == ref.emplace(k, k * 3).second;
+        }
+        std::vector<int> got, want;
+        sl.rangeApply(2500, 7000, [&](const int &k, const int &) { got.push_back(k); });
+        for (auto it = ref.lower_bound(2500); it != ref.end() && it->first <= 7000; ++it)
+            want.push_back(it->first);
+        ts.check(ok && got == want && sl.size() == ref.size(), "SkipList matches std::map");
+
+        EpochDomain::instance().synchronize();
+        ts.check_eq_int((int)EpochDomain::instance().pending(), 0, "erased skip list nodes reclaimed");
+    }
+
+    // --- Test: racing insert and delete of the same IDs leave no stale postings ---
+    {
+        auto race = [&](auto &e, const std::string &name) {
+            const int pairs = 4, perPair = (int)RecordHeap::kChunkSize / pairs;
+            std::vector<std::thread> writers;
+            for (int p = 0; p < pairs; ++p) {
+                int base = 4100000 + p * perPair;
+                writers.emplace_back([&e, base, perPair] {
+                    for (int i = 0; i < perPair; ++i) e.insertRecord({base + i, "Zed", "Z", "CS", 2.0, false});
+                });
+                writers.emplace_back([&e, base, perPair] {
+                    for (int i = 0; i < perPair; ++i)
+                        while (!e.deleteById(base + i)) std::this_thread::yield();
+                });
+            }
+            for (auto &th : writers) th.join();
+            const Postings *zed = e.lastIndex.find("zed");
+            ts.check((!zed || zed->empty()) && e.stats().liveRows == 0,
+                     name + ": every deleted row left its postings");
+            int cmp = 0;
+            ts.check(e.compact() == RecordHeap::kChunkSize && e.prefixByLast("Zed", cmp).empty(),
+                     name + ": every row retired exactly once");
+        };
+        ConcurrentEngine c1;
+        SkipListEngine c2;
+        race(c1, "ConcurrentEngine");
+        race(c2, "SkipListEngine");
+    }
+
+    // --- Test: SkipListEngine with parallel writers ---
+    {
+        SkipListEngine se;
+        const int threads = 4, perThread = 2000;
+        std::vector<std::thread> writers;
+        for (int t = 0; t < threads; ++t) {
+            writers.emplace_back([&, t] {
+                for (int i = 0; i < perThread; ++i)
+                    se.insertRecord({4000000 + i * threads + t, "Skip", "S", "Math", 3.5, false});
+                for (int i = 1; i < perThread; i += 2)
+                    se.deleteById(4000000 + i * threads + t);
+            });
+        }
+        for (auto &th : writers) th.join();
+        int cmp = 0;
+        ts.check_eq_int((int)se.rangeById(4000000, 4000000 + threads * perThread, cmp).size(),
+                        threads * perThread / 2, "SkipListEngine range after parallel writers");
+        ts.check(se.findById(4000000 + 4 * threads, cmp) && !se.findById(4000000 + threads, cmp),
+                 "SkipListEngine findById after parallel writers");
+    }
+
+    // --- Test: compact() frees dead heap chunks; epoch keeps pinned rows alive ---
+    {
+        Engine ce;
+        const int chunk = (int)RecordHeap::kChunkSize, n = 2 * chunk + 100;
+        for (int i = 0; i < n; ++i)
+            ce.insertRecord({5000000 + i, "Compact" + std::to_string(i % 50), "C", "CS", 2.5, false});
+
+        int cmp = 0;
+        bool pinnedOk;
+        size_t pinnedReclaimed;
+        {
+            EpochGuard pin;
+            const Record *pinned = ce.findById(5000000 + 7, cmp);
+            for (int i = 0; i < chunk; ++i) ce.deleteById(5000000 + i);
+            ts.check_eq_int((int)ce.compact(), chunk, "compact frees the fully deleted chunk");
+            pinnedOk = pinned && pinned->id == 5000000 + 7 && pinned->last == "Compact7";  // still readable
+            pinnedReclaimed = ce.stats().reclaimedRows;
+        }
+        ts.check(pinnedOk, "row stays readable inside an EpochGuard after compact");
+        ts.check_eq_int((int)pinnedReclaimed, 0, "pinned chunk not reported as reclaimed");
+        ts.check_eq_int((int)ce.compact(), 0, "compact is idempotent");
+        ts.check_eq_int((int)ce.stats().reclaimedRows, chunk, "stats report reclaimed rows once freed");
+        const Record *r = ce.findById(5000000 + chunk + 5, cmp);
+        ts.check(r && r->id == 5000000 + chunk + 5 && !ce.findById(5000000 + 5, cmp),
+                 "live rows unaffected by compact");
+        int expected7 = 0;
+        for (int i = chunk; i < n; ++i) expected7 += i % 50 == 7;
+        ts.check_eq_int((int)ce.prefixByLast("compact7", cmp).size(), expected7, "postings unaffected by compact");
+    }
+
+    // --- Test: lock-free readers racing deletes and compaction ---
+    {
+        ConcurrentEngine ce;
+        const int chunk = (int)RecordHeap::kChunkSize, n = 2 * chunk;
+        for (int i = 0; i < n; ++i)
+            ce.insertRecord({6000000 + i, "Race", "R", "EE", 1.5, false});
+
+        std::atomic<bool> done{false};
+        std::atomic<int> badReads{0};
+        std::vector<std::thread> readers;
+        for (int t = 0; t < 3; ++t) {
+            readers.emplace_back([&, t] {
+                std::mt19937 rng(40 + t);
+                while (!done.load()) {
+                    EpochGuard pin;
+                    int id = 6000000 + (int)(rng() % n), cmp = 0;
+                    const Record *r = ce.findById(id, cmp);
+                    if (r && (r->id != id || r->last != "Race")) ++badReads;
+                    for (const Record *row : ce.rangeById(id, id + 10, cmp))
+                        if (row->last != "Race") ++badReads;
+                }
+            });
+        }
+        for (int i = 0; i < chunk; ++i) {
+            ce.deleteById(6000000 + i);
+            if (i % 4096 == 0) ce.compact();
+        }
+        size_t reclaimed = ce.compact();
+        done = true;
+        for (auto &th : readers) th.join();
+        int cmp = 0;
+        ts.check(badReads.load() == 0, "lock-free readers never see freed rows");
+        ts.check(reclaimed == (size_t)chunk && ce.rangeById(6000000, 6000000 + n, cmp).size() == (size_t)chunk,
+                 "concurrent compaction reclaims the deleted chunk");
+    }
+
+    // --- Test: PersistentBST versions stay frozen (vs std::map) ---
+    {
+        using PTree = PersistentBST<int, IdEntry, GpaSummary>;
+        PTree t;
+        std::map<int, double> ref;
+        std::vector<std::pair<PTree, std::map<int, double>>> versions;
+        std::mt19937 rng(36);
+        for (int step = 0; step < 6000; ++step) {
+            int k = (int)(rng() % 1500);
+            if (rng() % 3) {
+                t.insert(k, IdEntry{k, (k % 7) * 0.5});
+                ref.emplace(k, (k % 7) * 0.5);
+            } else {
+                t.erase(k);
+                ref.erase(k);
+            }
+            if (step % 1000 == 999) versions.emplace_back(t, ref);
+        }
+        bool ok = true;
+        for (auto &[version, expect] : versions) {
+            std::vector<int> got, want;
+            double sum = 0;
+            version.forEach([&](const int &k, const IdEntry &e) { got.push_back(k); ok &= e.recordID == k; });
+            for (auto &kv : expect) { want.push_back(kv.first); sum += kv.second; }
+            auto agg = version.aggregate();
+            ok &= got == want && agg.count == expect.size() && std::abs(agg.sum - sum) < 1e-6;
+            int cmp = 0;
+            ok &= version.countRange(200, 900, cmp) ==
+                  (size_t)std::distance(expect.lower_bound(200), expect.upper_bound(900));
+        }
+        ts.check(ok, "PersistentBST versions match std::map snapshots");
+        ts.check(t.stats().maxDepth <= 2 * 11 + 2, "PersistentBST stays balanced");
+    }
+
+    // --- Test: PersistentEngine snapshot is frozen while writers continue ---
+    {
+        PersistentEngine pe;
+        for (int i = 0; i < 2000; ++i)
+            pe.insertRecord({7000000 + i, "Snap", "S", "CS", (i % 5) * 1.0, false});
+
+        int cmp = 0;
+        auto snap = pe.snapshot();
+        double avgBefore = snap.gpaStatsById(7000000, 7002000, cmp).avg();
+
+        std::atomic<int> badReads{0};
+        std::thread reader([&] {
+            for (int pass = 0; pass < 20; ++pass) {
+                int c = 0;
+                auto rows = snap.rangeById(7000000, 7009999, c);
+                if (rows.size() != 2000 || snap.countById(7000000, 7009999, c) != 2000) ++badReads;
+                for (const Record *r : rows)
+                    if (r->id < 7000000 || r->id >= 7002000) ++badReads;
+            }
+        });
+        for (int i = 0; i < 1000; ++i) pe.deleteById(7000000 + i);
+        for (int i = 2000; i < 3000; ++i)
+            pe.insertRecord({7000000 + i, "Snap", "S", "CS", 4.0, false});
+        reader.join();
+
+        ts.check(badReads.load() == 0, "snapshot readers see the frozen row set");
+        ts.check(snap.findById(7000000 + 10, cmp) && !snap.findById(7002500, cmp),
+                 "snapshot ignores later deletes and inserts");
+        ts.check(std::abs(snap.gpaStatsById(7000000, 7002000, cmp).avg() - avgBefore) < 1e-9,
+                 "snapshot aggregates are frozen");
+        ts.check(!pe.findById(7000000 + 10, cmp) && pe.findById(7002500, cmp),
+                 "live engine sees the writes");
+        ts.check_eq_int((int)pe.compact(), 0, "compact is deferred while a snapshot is open");
+    }
+
+    // --- Test: read views see the engine as of the moment they were opened ---
+    {
+        auto isolation = [&](auto &eng, const std::string &name) {
+            for (int i = 0; i < 10; ++i)
+                eng.insertRecord({8000000 + i, "Mvcc", "V1", "CS", 2.0, false});
+            int cmp = 0;
+            bool ok = true;
+            {
+                auto view = eng.beginRead();
+                eng.deleteById(8000001);
+                eng.deleteById(8000002);
+                eng.insertRecord({8000001, "Mvcc", "V2", "CS", 3.5, false});
+                eng.insertRecord({8000100, "Mvcc", "V2", "CS", 3.5, false});
+                ok = ok && eng.insertRecord({8000001, "Mvcc", "V3", "CS", 1.0, false}) == -1;
+
+                const Record *old = view.findById(8000001, cmp);
+                const Record *cur = eng.findById(8000001, cmp);
+                ok = ok && old && old->first == "V1" && cur && cur->first == "V2";
+                ok = ok && view.findById(8000002, cmp) && !eng.findById(8000002, cmp);
+                ok = ok && !view.findById(8000100, cmp) && eng.findById(8000100, cmp);
+                ok = ok && view.rangeById(8000000, 8000200, cmp).size() == 10;
+                ok = ok && eng.rangeById(8000000, 8000200, cmp).size() == 10;
+                ok = ok && view.prefixByLast("mvc", cmp).size() == 10;
+                ok = ok && eng.prefixByLast("mvc", cmp).size() == 10;
+                ok = ok && eng.stats().deadVersions == 2;
+            }
+            ts.check(ok, name + ": view keeps its versions while writers continue");
+
+            auto st = eng.stats();
+            const Record *cur = eng.findById(8000001, cmp);
+            ts.check(st.deadVersions == 0 && st.liveRows == 10 && cur && cur->first == "V2" &&
+                     eng.prefixByLast("mvc", cmp).size() == 10 &&
+                     eng.lastIndex.find("mvcc")->size() == 10,
+                     name + ": closing the view collects dead versions");
+        };
+        Engine e1;
+        SplayEngine e2;
+        ConcurrentEngine e3;
+        SkipListEngine e4;
+        isolation(e1, "Engine");
+        isolation(e2, "SplayEngine");
+        isolation(e3, "ConcurrentEngine");
+        isolation(e4, "SkipListEngine");
+    }
+
+    // --- Test: version chains serve views opened at different times ---
+    {
+        Engine eng;
+        int cmp = 0;
+        eng.insertRecord({8100000, "Chain", "A", "CS", 1.0, false});
+        auto v1 = std::make_unique<Engine::ReadView>(eng.beginRead());
+        eng.deleteById(8100000);
+        eng.insertRecord({8100000, "Chain", "B", "CS", 2.0, false});
+        auto v2 = std::make_unique<Engine::ReadView>(eng.beginRead());
+        eng.deleteById(8100000);
+        eng.insertRecord({8100000, "Chain", "C", "CS", 3.0, false});
+
+        auto firstAt = [&](const Engine::ReadView &v) {
+            const Record *r = v.findById(8100000, cmp);
+            return r ? r->first : std::string("-");
+        };
+        ts.check(firstAt(*v1) == "A" && firstAt(*v2) == "B" && eng.findById(8100000, cmp)->first == "C",
+                 "each view reads its own version of a reinserted ID");
+
+        v1.reset();
+        ts.check(firstAt(*v2) == "B" && eng.stats().deadVersions == 1,
+                 "closing the oldest view only collects versions nobody sees");
+        ts.check_eq_int((int)v2->prefixByLast("chain", cmp).size(), 1, "view prefix query sees one version");
+        v2.reset();
+        ts.check(eng.stats().deadVersions == 0 && eng.lastIndex.find("chain")->size() == 1 &&
+                 eng.findById(8100000, cmp)->first == "C",
+                 "all dead versions collected once the views are closed");
+    }
+
+    // --- Test: rows deleted under a view are only reclaimed after it closes ---
+    {
+        ConcurrentEngine ce;
+        const int chunk = (int)RecordHeap::kChunkSize;
+        for (int i = 0; i < chunk + 10; ++i)
+            ce.insertRecord({8200000 + i, "Gc", "G", "CS", 3.0, false});
+        {
+            auto view = ce.beginRead();
+            for (int i = 0; i < chunk; ++i) ce.deleteById(8200000 + i);
+            ts.check_eq_int((int)ce.compact(), 0, "compact keeps rows an open view can reach");
+            int cmp = 0;
+            ts.check_eq_int((int)view.rangeById(8200000, 8300000, cmp).size(), chunk + 10,
+                            "view still reads every deleted row");
+        }
+        ts.check_eq_int((int)ce.compact(), chunk, "compact frees the chunk after the view closes");
+        ts.check_eq_int((int)ce.stats().liveRows, 10, "live rows after collection");
+    }
+
+    // --- Test: view readers stay consistent under concurrent writers ---
+    {
+        SkipListEngine se;
+        for (int i = 0; i < 1000; ++i)
+            se.insertRecord({8300000 + i, "Race", "R", "CS", 2.0, false});
+        std::atomic<int> badReads{0};
+        {
+            auto view = se.beginRead();
+            std::thread writer([&] {
+                for (int round = 0; round < 3; ++round)
+                    for (int i = 0; i < 1000; i += 3) {
+                        se.deleteById(8300000 + i);
+                        se.insertRecord({8300000 + i, "Race", "W", "CS", 4.0, false});
+                    }
+            });
+            std::thread reader([&] {
+                for (int pass = 0; pass < 30; ++pass) {
+                    int cmp = 0;
+                    auto rows = view.rangeById(8300000, 8301000, cmp);
+                    if (rows.size() != 1000) ++badReads;
+                    for (const Record *r : rows)
+                        if (r->first != "R") ++badReads;
+                }
+            });
+            writer.join();
+            reader.join();
+        }
+        int cmp = 0;
+        ts.check(badReads.load() == 0, "view reads are stable while writers reinsert");
+        ts.check(se.stats().deadVersions == 0 && se.rangeById(8300000, 8301000, cmp).size() == 1000 &&
+                 se.findById(8300003, cmp)->first == "W",
+                 "writes visible and garbage collected after the view closes");
+    }
+
+    // --- Test: updateById rewrites GPA in place, strings as a new version, and only the affected indexes ---
+    {
+        Engine eng;
+        for (int i = 0; i < 5; ++i)
+            eng.insertRecord({8400000 + i, "Upd", "U", "CS", 2.0, false});
+        size_t heapBefore = eng.heap.size();
+        int cmp = 0;
+
+        RecordPatch gpaOnly;
+        gpaOnly.gpa = 4.0;
+        RecordPatch rename;
+        rename.last = "Moved";
+        rename.major = "EE";
+        ts.check(eng.updateById(8400001, gpaOnly), "updateById succeeds on live IDs");
+        ts.check(!eng.updateById(8400099, gpaOnly), "updateById rejects unknown IDs");
+        ts.check_eq_int((int)eng.heap.size(), (int)heapBefore, "GPA-only updates do not grow the heap");
+        const Record *held = eng.findById(8400002, cmp);
+        eng.updateById(8400002, rename);
+        ts.check(eng.heap.size() == heapBefore + 1 && held->last == "Upd" && held->major == "CS",
+                 "string updates leave held rows untouched");
+
+        const Record *r = eng.findById(8400002, cmp);
+        ts.check(r && r->last == "Moved" && r->major == "EE" && r->first == "U",
+                 "patched columns changed, others kept");
+        ts.check_eq_int((int)eng.prefixByLast("upd", cmp).size(), 4, "old surname postings lose the row");
+        ts.check_eq_int((int)eng.prefixByLast("mov", cmp).size(), 1, "new surname postings gain the row");
+        ts.check(std::abs(eng.gpaStatsById(8400000, 8400004, cmp).sum - 12.0) < 1e-9,
+                 "GPA aggregate follows the update");
+
+        // With a read view open the update becomes a new version
+        {
+            auto view = eng.beginRead();
+            RecordPatch back;
+            back.last = "Upd";
+            back.gpa = 1.0;
+            eng.updateById(8400002, back);
+            const Record *old = view.findById(8400002, cmp);
+            const Record *cur = eng.findById(8400002, cmp);
+            ts.check(old && old->last == "Moved" && cur && cur->last == "Upd" && cur->gpa == 1.0,
+                     "view keeps the pre-update version");
+            ts.check_eq_int((int)view.prefixByLast("mov", cmp).size(), 1, "view prefix sees the old surname");
+            ts.check_eq_int((int)eng.prefixByLast("mov", cmp).size(), 0, "engine prefix sees the new surname");
+        }
+        ts.check(eng.stats().deadVersions == 0 && eng.lastIndex.find("upd")->size() == 5 &&
+                 !eng.lastIndex.find("moved"),
+                 "old version collected after the view closes");
+    }
+
+    // --- Test: updateById on a concurrent idIndex copies the row ---
+    {
+        SkipListEngine se;
+        se.insertRecord({8500000, "Cow", "C", "CS", 2.0, false});
+        RecordPatch patch;
+        patch.last = "Other";
+        patch.gpa = 3.0;
+        int cmp = 0;
+        ts.check(se.updateById(8500000, patch), "concurrent updateById succeeds");
+        const Record *r = se.findById(8500000, cmp);
+        ts.check(r && r->last == "Other" && r->gpa == 3.0 && se.heap.size() == 2 &&
+                 se.prefixByLast("cow", cmp).empty() && se.prefixByLast("oth", cmp).size() == 1 &&
+                 se.stats().liveRows == 1,
+                 "concurrent update writes a new version and moves the posting");
+    }
+
+    // --- Test: lock-free findById never misses a record being updated ---
+    {
+        auto neverMissed = [&](auto &eng, const std::string &name) {
+            const int kIds = 64;
+            for (int i = 0; i < kIds; ++i) eng.insertRecord({8550000 + i, "Upd", "U", "CS", 2.0, false});
+            std::atomic<bool> stop{false};
+            std::atomic<int> misses{0};
+            std::thread reader([&] {
+                int cmp = 0;
+                while (!stop.load()) {
+                    for (int i = 0; i < kIds; ++i) {
+                        if (!eng.findById(8550000 + i, cmp)) ++misses;
+                    }
+                }
+            });
+            for (int round = 0; round < 200; ++round) {
+                RecordPatch patch;
+                patch.first = "U" + std::to_string(round);
+                for (int i = 0; i < kIds; ++i) eng.updateById(8550000 + i, patch);
+                if (round % 16 == 0) std::this_thread::yield();
+            }
+            stop = true;
+            reader.join();
+            ts.check_eq_int(misses.load(), 0, name + ": readers always find an updated record");
+        };
+        ConcurrentEngine ce;
+        SkipListEngine se;
+        neverMissed(ce, "ConcurrentEngine");
+        neverMissed(se, "SkipListEngine");
+    }
+
+    // --- Test: BST::insertSorted matches single inserts (merge and key-by-key paths) ---
+    {
+        std::mt19937 rng(39);
+        bool ok = true;
+        for (int existing : {0, 50, 5000}) {
+            BST<int, int> tree;
+            std::map<int, int> ref;
+            for (int i = 0; i < existing; ++i) {
+                int k = (int)(rng() % 20000);
+                tree.insert(k, i);
+                ref.insert({k, i});
+            }
+            std::vector<std::pair<int, int>> batch;
+            for (int i = 0; i < 300; ++i) batch.push_back({(int)(rng() % 20000), -i});
+            std::stable_sort(batch.begin(), batch.end(),
+                             [](const auto &a, const auto &b) { return a.first < b.first; });
+            std::vector<char> inserted;
+            size_t added = tree.insertSorted(batch, inserted);
+            size_t expected = 0;
+            for (size_t i = 0; i < batch.size(); ++i) {
+                bool fresh = ref.insert(batch[i]).second;
+                ok = ok && (bool)inserted[i] == fresh;
+                expected += fresh;
+            }
+            ok = ok && added == expected && tree.size() == ref.size();
+            std::vector<std::pair<int, int>> walked;
+            tree.forEach([&](const int &k, const int &v) { walked.push_back({k, v}); });
+            ok = ok && walked == std::vector<std::pair<int, int>>(ref.begin(), ref.end());
+            ok = ok && tree.countRange(0, 10000) == (size_t)std::distance(ref.begin(), ref.upper_bound(10000));
+        }
+        ts.check(ok, "BST::insertSorted agrees with std::map");
+    }
+
+    // --- Test: insertBatch gives the same engine as row-by-row inserts ---
+    {
+        auto sameAsSingle = [&](auto &batched, auto &single, const std::string &name) {
+            std::vector<Record> rows;
+            for (int i = 0; i < 3000; ++i)
+                rows.push_back({8600000 + (i * 7919) % 2500, "Batch" + std::to_string(i % 13), "B",
+                                "CS", (i % 4) * 1.0, false});
+            single.insertRecord({8600005, "Before", "B", "CS", 1.0, false});
+            batched.insertRecord({8600005, "Before", "B", "CS", 1.0, false});
+            size_t singleAdded = 0;
+            for (const Record &r : rows) singleAdded += single.insertRecord(r) >= 0;
+            size_t batchAdded = batched.insertBatch(rows);
+
+            int cmp = 0;
+            bool ok = batchAdded == singleAdded && batched.stats().liveRows == single.stats().liveRows;
+            auto a = batched.rangeById(8600000, 8700000, cmp), b = single.rangeById(8600000, 8700000, cmp);
+            ok = ok && a.size() == b.size();
+            for (size_t i = 0; ok && i < a.size(); ++i)
+                ok = a[i]->id == b[i]->id && a[i]->last == b[i]->last && a[i]->gpa == b[i]->gpa;
+            for (int k = 0; k < 13; ++k) {
+                std::string name = "batch" + std::to_string(k);
+                ok = ok && batched.prefixByLast(name, cmp).size() == single.prefixByLast(name, cmp).size();
+            }
+            ts.check(ok, name + ": insertBatch matches insertRecord");
+        };
+        Engine a1, b1;
+        TreapEngine a2, b2;
+        ConcurrentEngine a3, b3;
+        sameAsSingle(a1, b1, "Engine");
+        sameAsSingle(a2, b2, "TreapEngine");
+        sameAsSingle(a3, b3, "ConcurrentEngine");
+
+        // A batch is one commit: a view opened before it sees none of it
+        Engine eng;
+        eng.insertRecord({8700000, "Ghost", "G", "CS", 1.0, false});
+        int cmp = 0;
+        {
+            auto view = eng.beginRead();
+            eng.deleteById(8700000);
+            std::vector<Record> rows = {{8700000, "Ghost", "New", "CS", 2.0, false},
+                                        {8700001, "Ghost", "New", "CS", 2.0, false}};
+            ts.check_eq_int((int)eng.insertBatch(rows), 2, "insertBatch revives an ID deleted under a view");
+            ts.check(view.findById(8700000, cmp)->first == "G" && !view.findById(8700001, cmp) &&
+                     eng.findById(8700000, cmp)->first == "New",
+                     "view sees none of a later batch");
+        }
+        ts.check_eq_int((int)eng.prefixByLast("ghost", cmp).size(), 2, "postings after batch and GC");
+    }
+
+    // --- Test: findManyById agrees with findById ---
+    {
+        auto sameAsFind = [&](auto &eng, const std::string &name) {
+            for (int i = 0; i < 2000; ++i)
+                eng.insertRecord({8800000 + 2 * i, "Many", "M", "CS", 3.0, false});
+            for (int i = 0; i < 2000; i += 5) eng.deleteById(8800000 + 2 * i);
+            std::mt19937 rng(40);
+            std::vector<int> ids;
+            for (int i = 0; i < 1000; ++i) ids.push_back(8800000 + (int)(rng() % 4100));
+            int cmpMany = 0, cmpLoop = 0;
+            auto found = eng.findManyById(ids, cmpMany);
+            bool ok = found.size() == ids.size();
+            for (size_t i = 0; ok && i < ids.size(); ++i) {
+                int cmp = 0;
+                ok = found[i] == eng.findById(ids[i], cmp);
+                cmpLoop += cmp;
+            }
+            ts.check(ok, name + ": findManyById matches findById");
+            ts.check_eq_int(cmpMany, cmpLoop, name + ": findManyById counts the same comparisons");
+        };
+        Engine e1;
+        ConcurrentEngine e2;
+        sameAsFind(e1, "Engine");
+        sameAsFind(e2, "ConcurrentEngine");
+    }
+
+    // --- Test: deleteBatch agrees with deleteById ---
+    {
+        auto sameAsSingle = [&](auto &batched, auto &single, const std::string &name) {
+            for (int i = 0; i < 3000; ++i) {
+                Record r{8900000 + i, "Cohort" + std::to_string(i % 7), "C", "CS", (i % 4) * 1.0, false};
+                batched.insertRecord(r);
+                single.insertRecord(r);
+            }
+            std::vector<int> ids;
+            for (int i = 0; i < 3000; i += 2) ids.push_back(8900000 + i);
+            ids.push_back(8900000);        // repeated
+            ids.push_back(8999999);        // unknown
+            size_t singleDeleted = 0;
+            for (int id : ids) singleDeleted += single.deleteById(id);
+            size_t batchDeleted = batched.deleteBatch(ids);
+
+            int cmp = 0;
+            bool ok = batchDeleted == singleDeleted && batchDeleted == 1500 &&
+                      batched.stats().liveRows == single.stats().liveRows;
+            ok = ok && batched.rangeById(8900000, 8903000, cmp).size() == 1500;
+            for (int k = 0; k < 7; ++k) {
+                std::string last = "cohort" + std::to_string(k);
+                ok = ok && batched.lastIndex.find(last)->size() == single.lastIndex.find(last)->size();
+            }
+            ok = ok && !batched.findById(8900002, cmp) && batched.findById(8900003, cmp);
+            ts.check(ok, name + ": deleteBatch matches deleteById");
+        };
+        Engine a1, b1;
+        SplayEngine a2, b2;
+        ConcurrentEngine a3, b3;
+        PersistentEngine a4, b4;
+        sameAsSingle(a1, b1, "Engine");
+        sameAsSingle(a2, b2, "SplayEngine");
+        sameAsSingle(a3, b3, "ConcurrentEngine");
+        sameAsSingle(a4, b4, "PersistentEngine");
+
+        // Under a read view the batch is deferred like single deletes
+        Engine eng;
+        for (int i = 0; i < 10; ++i) eng.insertRecord({8950000 + i, "Defer", "D", "CS", 2.0, false});
+        int cmp = 0;
+        {
+            auto view = eng.beginRead();
+            ts.check_eq_int((int)eng.deleteBatch(std::vector<int>{8950001, 8950002, 8950003}), 3,
+                            "deleteBatch under a view");
+            ts.check(view.rangeById(8950000, 8950009, cmp).size() == 10 &&
+                     eng.rangeById(8950000, 8950009, cmp).size() == 7,
+                     "view still sees the batch-deleted rows");
+        }
+        ts.check(eng.lastIndex.find("defer")->size() == 7, "postings collected after the view closes");
+    }
+
+    // --- Test: Postings stays sorted under adds, tombstones and compaction (vs std::set) ---
+    {
+        std::mt19937 rng(42);
+        Postings list;
+        std::set<int> ref;
+        bool ok = true;
+        for (int step = 0; step < 20000 && ok; ++step) {
+            int rid = (int)(rng() % 3000);
+            if (rng() % 3 == 0) {
+                ok = list.remove(rid) == (ref.erase(rid) == 1);
+            } else {
+                if (rng() % 4 == 0) rid = 3000 + step;   // mostly appends, like fresh RIDs
+                list.add(rid);
+                ref.insert(rid);
+            }
+            ok = ok && list.size() == ref.size() && list.contains(rid) == (ref.count(rid) == 1);
+        }
+        std::vector<int> walked;
+        list.forEach([&](int rid) { walked.push_back(rid); });
+        ok = ok && walked == std::vector<int>(ref.begin(), ref.end());
+        ts.check(ok, "Postings matches std::set");
+
+        Postings evens, thirds;
+        for (int i = 0; i < 600; i += 2) evens.add(i);
+        for (int i = 0; i < 600; i += 3) thirds.add(i);
+        evens.remove(12);
+        std::vector<int> both = evens.intersect(thirds);
+        ts.check(both.size() == 99 && both.front() == 0 && both[2] == 18 &&
+                 std::is_sorted(both.begin(), both.end()),
+                 "Postings::intersect skips tombstones");
+    }
+
+    // --- Test: surname changes keep postings sorted ---
+    {
+        Engine eng;
+        for (int i = 0; i < 6; ++i) eng.insertRecord({9000000 + i, i % 2 ? "Odd" : "Even", "P", "CS", 2.0, false});
+        RecordPatch toEven;
+        toEven.last = "Even";
+        RecordPatch toOdd;
+        toOdd.last = "Odd";
+        eng.updateById(9000001, toEven);
+        eng.updateById(9000001, toOdd);
+        eng.updateById(9000003, toEven);
+        std::vector<int> evenRids;
+        eng.lastIndex.find("even")->forEach([&](int rid) { evenRids.push_back(rid); });
+        int cmp = 0;
+        ts.check(evenRids == std::vector<int>{0, 2, 4, 8} && eng.prefixByLast("odd", cmp).size() == 2,
+                 "renamed rows append their new RIDs in sorted position");
+    }
+
+    // --- Test: compressed postings (multi-byte deltas, block boundaries, size) ---
+    {
+        Postings wide, dense;
+        std::vector<int> want;
+        for (int i = 0; i < 1000; ++i) {
+            int rid = i * 70001;               // deltas need three varint bytes
+            wide.add(rid);
+            want.push_back(rid);
+        }
+        for (int i = 0; i < 10000; ++i) dense.add(i);
+        bool ok = wide.toVector() == want && wide.contains(70001 * 128) && !wide.contains(70001 * 128 + 1);
+        ok = ok && wide.remove(70001 * 127) && wide.remove(70001 * 128) && !wide.contains(70001 * 128);
+        ok = ok && wide.size() == 998;
+        ts.check(ok, "Postings decodes wide deltas across block boundaries");
+        ts.check(dense.memoryBytes() < 2 * 10000, "dense postings take under 2 bytes per RID");
+
+        Engine eng;
+        for (int i = 0; i < 5000; ++i) eng.insertRecord({9100000 + i, "Dense", "D", "CS", 2.0, false});
+        ts.check(eng.stats().postingsBytes < 5000 * sizeof(int), "engine postings are compressed");
+    }
+
+    // --- Test: save/load round trip (deleted, updated and reinserted rows) ---
+    {
+        const std::string path = "test_snapshot.bin";
+        Engine src;
+        for (int i = 0; i < 2000; ++i) {
+            src.insertRecord({9200000 + (i * 7919) % 2000, "Save" + std::to_string(i % 13), "F" + std::to_string(i),
+                              i % 3 ? "CS" : "Math", (i % 5) * 0.75, false});
+        }
+        for (int i = 0; i < 2000; i += 4) src.deleteById(9200000 + i);
+        RecordPatch patch;
+        patch.last = "Moved";
+        patch.gpa = 3.9;
+        src.updateById(9200001, patch);
+        src.insertRecord({9200004, "Back", "B", "EE", 1.5, false});
+        ts.check(src.save(path), "save writes a snapshot");
+
+        auto sameAsSource = [&](auto &dst, const std::string &name) {
+            bool ok = dst.load(path);
+            int cmp = 0;
+            ok = ok && dst.stats().liveRows == src.stats().liveRows;
+            for (int id = 9200000; ok && id < 9200000 + 2000; ++id) {
+                const Record *a = src.findById(id, cmp), *b = dst.findById(id, cmp);
+                ok = (a == nullptr) == (b == nullptr) &&
+                     (!a || (a->last == b->last && a->first == b->first && a->major == b->major && a->gpa == b->gpa));
+            }
+            for (const char *prefix : {"save1", "moved", "back", "s"})
+                ok = ok && dst.prefixByLast(prefix, cmp).size() == src.prefixByLast(prefix, cmp).size();
+            ok = ok && dst.insertRecord({9200000, "New", "N", "CS", 2.0, false}) >= 0 &&
+                 dst.insertRecord({9200001, "Dup", "D", "CS", 2.0, false}) == -1;
+            ts.check(ok, name + ": load restores rows and both indexes");
+            ts.check(!dst.load(path), name + ": load refuses a non-empty engine");
+        };
+        Engine e1;
+        SplayEngine e2;
+        ConcurrentEngine e3;
+        PersistentEngine e4;
+        sameAsSource(e1, "Engine");
+        sameAsSource(e2, "SplayEngine");
+        sameAsSource(e3, "ConcurrentEngine");
+        sameAsSource(e4, "PersistentEngine");
+        int cmp = 0;
+        ts.check_eq_int((int)e1.gpaStatsById(9200000, 9201999, cmp).count, (int)src.stats().liveRows + 1,
+                        "loaded idIndex keeps GPA aggregates");   // + the row inserted after loading
+
+        // A truncated file is rejected and leaves the engine empty
+        {
+            std::FILE *f = std::fopen(path.c_str(), "rb");
+            std::vector<char> bytes(1 << 20);
+            bytes.resize(std::fread(bytes.data(), 1, bytes.size(), f));
+            std::fclose(f);
+            f = std::fopen(path.c_str(), "wb");
+            std::fwrite(bytes.data(), 1, bytes.size() - 5, f);
+            std::fclose(f);
+        }
+        Engine bad;
+        ts.check(!bad.load(path) && bad.stats().liveRows == 0, "load rejects a truncated snapshot");
+        ts.check(!bad.load("no_such_snapshot.bin"), "load reports a missing file");
+        std::remove(path.c_str());
+    }
+
+    // --- Test: mapped record store (views into the file, in ID order) ---
+    {
+        const std::string path = "test_heap.bin";
+        ConcurrentEngine src;
+        for (int i = 0; i < 3000; ++i) {
+            src.insertRecord({9300000 + (i * 611) % 3000, "Map" + std::to_string(i % 9), "F" + std::to_string(i),
+                              i % 2 ? "EE" : "", i * 0.001, false});
+        }
+        for (int i = 0; i < 3000; i += 5) src.deleteById(9300000 + i);
+        RecordPatch patch;
+        patch.first = "Patched";
+        src.updateById(9300001, patch);
+        ts.check(src.exportMapped(path), "exportMapped writes a store file");
+
+        MappedRecordStore store;
+        bool ok = store.open(path) && store.size() == src.stats().liveRows;
+        int cmp = 0, storeCmp = 0;
+        for (int id = 9299999; ok && id <= 9303000; ++id) {
+            const Record *a = src.findById(id, cmp);
+            std::optional<RecordView> b = store.findById(id, storeCmp);
+            ok = (a == nullptr) == !b &&
+                 (!a || (b->id == id && b->last == a->last && b->first == a->first && b->major == a->major &&
+                         b->gpa == a->gpa));
+        }
+        ts.check(ok, "mapped store finds what the engine finds");
+        ts.check(storeCmp <= 13, "mapped findById is a binary search");
+
+        std::vector<RecordView> range = store.rangeById(9300010, 9300029, cmp);
+        ok = range.size() == 16;
+        for (size_t i = 1; ok && i < range.size(); ++i) ok = range[i - 1].id < range[i].id;
+        ts.check(ok, "mapped rangeById returns live IDs in order");
+
+        MappedRecordStore moved = std::move(store);
+        std::optional<RecordView> patched = moved.findById(9300001, cmp);
+        ts.check(!store.isOpen() && patched && patched->toRecord().first == "Patched",
+                 "moved store keeps its mapping");
+
+        MappedRecordStore::Writer unordered("test_heap_bad.bin");
+        ts.check(unordered.add({2, "B", "B", "CS", 1.0, false}) && !unordered.add({1, "A", "A", "CS", 1.0, false}) &&
+                 !unordered.finish(),
+                 "store writer rejects out-of-order IDs");
+        ts.check(!moved.open("no_such_heap.bin") && !moved.isOpen(), "open reports a missing file");
+        Engine small;
+        small.insertRecord({1, "A", "A", "CS", 1.0, false});
+        small.save("test_heap_bad.bin");
+        ts.check(!moved.open("test_heap_bad.bin"), "open rejects a file that is not a store");
+        std::remove(path.c_str());
+        std::remove("test_heap_bad.bin");
+    }
+
+    // --- Test: write-ahead log replay (alone and on top of a snapshot) ---
+    {
+        const std::string logPath = "test_wal.log", snapPath = "test_wal_snap.bin";
+        std::remove(logPath.c_str());
+        auto sameRows = [&](Engine &a, Engine &b) {
+            int cmp = 0;
+            bool ok = a.stats().liveRows == b.stats().liveRows;
+            for (int id = 9400000; ok && id < 9400400; ++id) {
+                const Record *x = a.findById(id, cmp), *y = b.findById(id, cmp);
+                ok = (x == nullptr) == (y == nullptr) &&
+                     (!x || (x->last == y->last && x->first == y->first && x->major == y->major && x->gpa == y->gpa));
+            }
+            return ok && a.prefixByLast("wal", cmp).size() == b.prefixByLast("wal", cmp).size();
+        };
+
+        Engine live;
+        WriteAheadLog log;
+        ts.check(log.open(logPath), "log opens");
+        live.attachLog(&log);
+        for (int i = 0; i < 200; ++i) live.insertRecord({9400000 + i, "Wal" + std::to_string(i % 4), "W", "CS", 2.0, false});
+        std::vector<Record> batch;
+        for (int i = 200; i < 300; ++i) batch.push_back({9400000 + i, "Batch", "B", "EE", 3.0, false});
+        live.insertBatch(batch);
+        for (int i = 0; i < 100; i += 3) live.deleteById(9400000 + i);
+        RecordPatch patch;
+        patch.last = "Renamed";
+        patch.gpa = 3.5;
+        live.updateById(9400001, patch);
+        ts.check(live.save(snapPath), "save with a log attached");
+        uint64_t snapshotLsn = log.lastLsn();
+
+        live.deleteBatch(std::vector<int>{9400200, 9400201, 9400202});
+        {
+            auto view = live.beginRead();   // deletes under a view take the deferred path
+            live.deleteById(9400250);
+            live.updateById(9400251, patch);
+        }
+        live.insertRecord({9400350, "Late", "L", "Bio", 1.0, false});
+        ts.check(log.durable() == log.lastLsn() && !log.hasFailed(), "every acknowledged write is durable");
+
+        Engine fromLog;
+        ts.check(fromLog.replay(logPath) && sameRows(live, fromLog), "replaying the whole log rebuilds the engine");
+        Engine fromSnapshot;
+        bool ok = fromSnapshot.load(snapPath) && fromSnapshot.logPosition == snapshotLsn;
+        ts.check(ok && fromSnapshot.replay(logPath) && sameRows(live, fromSnapshot) &&
+                 fromSnapshot.logPosition == log.lastLsn(),
+                 "snapshot + log tail rebuilds the engine");
+
+        // A torn record at the end is ignored by replay and cut off by open
+        live.attachLog(nullptr);
+        log.close();
+        {
+            std::FILE *f = std::fopen(logPath.c_str(), "ab");
+            std::fwrite("\x20\0\0\0torn", 1, 8, f);
+            std::fclose(f);
+        }
+        Engine afterTear;
+        ts.check(afterTear.replay(logPath) && sameRows(live, afterTear), "replay stops at a torn tail");
+        WriteAheadLog reopened;
+        ts.check(reopened.open(logPath, afterTear.logPosition), "log reopens after a torn tail");
+        afterTear.attachLog(&reopened);
+        afterTear.insertRecord({9400399, "Wal0", "R", "CS", 2.0, false});
+        ts.check(reopened.lastLsn() == afterTear.logPosition + 1, "reopened log continues the LSNs");
+        afterTear.attachLog(nullptr);
+        reopened.close();
+        Engine again;
+        ts.check(again.replay(logPath) && sameRows(afterTear, again), "appends after the tear replay");
+        std::remove(logPath.c_str());
+        std::remove(snapPath.c_str());
+    }
+
+    // --- Test: group commit under concurrent writers ---
+    {
+        const std::string logPath = "test_wal_group.log";
+        std::remove(logPath.c_str());
+        const int threads = 8, perThread = 150;
+        {
+            ConcurrentEngine eng;
+            WriteAheadLog log;
+            log.open(logPath);
+            eng.attachLog(&log);
+            std::vector<std::thread> writers;
+            for (int t = 0; t < threads; ++t) {
+                writers.emplace_back([&, t] {
+                    for (int i = 0; i < perThread; ++i)
+                        eng.insertRecord({9500000 + i * threads + t, "Group", "G", "CS", 2.0, false});
+                });
+            }
+            for (auto &th : writers) th.join();
+            ts.check(log.durable() == (uint64_t)threads * perThread && log.syncCount() <= log.durable(),
+                     "group commit makes every write durable with at most one fsync each");
+            eng.attachLog(nullptr);
+        }
+        ConcurrentEngine recovered;
+        int cmp = 0;
+        ts.check(recovered.replay(logPath) && recovered.stats().liveRows == (size_t)threads * perThread &&
+                 recovered.findById(9500000 + 777, cmp),
+                 "concurrently logged writes replay");
+        std::remove(logPath.c_str());
+    }
+
+    // --- Test: racing writers of one ID log in the order they took effect ---
+    {
+        const std::string logPath = "test_wal_race.log";
+        std::remove(logPath.c_str());
+        const int pairs = 4, perPair = 500;
+        {
+            ConcurrentEngine eng;
+            WriteAheadLog log;
+            log.open(logPath);
+            eng.attachLog(&log);
+            std::vector<std::thread> writers;
+            for (int p = 0; p < pairs; ++p) {
+                int base = 9510000 + p * perPair;
+                writers.emplace_back([&eng, base] {
+                    for (int i = 0; i < perPair; ++i) eng.insertRecord({base + i, "Zed", "Z", "CS", 2.0, false});
+                });
+                writers.emplace_back([&eng, base] {
+                    for (int i = 0; i < perPair; ++i)
+                        while (!eng.deleteById(base + i)) std::this_thread::yield();
+                });
+            }
+            for (auto &th : writers) th.join();
+            eng.attachLog(nullptr);
+        }
+        ConcurrentEngine recovered;
+        ts.check(recovered.replay(logPath) && recovered.stats().liveRows == 0,
+                 "replay of racing insert/delete pairs deletes every ID");
+        std::remove(logPath.c_str());
+    }
+
+    // --- Test: a failed log is reported to writers ---
+    {
+        Engine eng;
+        WriteAheadLog log;
+        if (log.open("/dev/full")) {   // every write fails with ENOSPC
+            eng.attachLog(&log);
+            ts.check(!eng.logFailed(), "fresh log has not failed");
+            eng.insertRecord({9520000, "Full", "F", "CS", 2.0, false});
+            int cmp = 0;
+            ts.check(eng.logFailed() && eng.findById(9520000, cmp), "failed write is reported by logFailed");
+            eng.attachLog(nullptr);
+        }
+    }
+
+    // --- Test: checkpoint while writers run, then recover from it plus the log tail ---
+    {
+        const std::string logPath = "test_ckpt.log", ckptPath = "test_ckpt.bin", savePath = "test_ckpt_save.bin";
+        std::remove(logPath.c_str());
+        auto readAll = [](const std::string &path) {
+            std::string bytes;
+            std::FILE *f = std::fopen(path.c_str(), "rb");
+            if (!f) return bytes;
+            char buf[4096];
+            size_t got;
+            while ((got = std::fread(buf, 1, sizeof(buf), f)) > 0) bytes.append(buf, got);
+            std::fclose(f);
+            return bytes;
+        };
+
+        Engine live;
+        WriteAheadLog log;
+        log.open(logPath);
+        live.attachLog(&log);
+        for (int i = 0; i < 3000; ++i) live.insertRecord({9600000 + i, "Ckpt" + std::to_string(i % 7), "C", "CS", 2.0, false});
+        for (int i = 0; i < 3000; i += 5) live.deleteById(9600000 + i);
+
+        // Quiet engine: the checkpoint is byte-for-byte what save() writes
+        ts.check(live.checkpoint(ckptPath) && live.save(savePath) && readAll(ckptPath) == readAll(savePath),
+                 "checkpoint of a quiet engine equals save()");
+        ts.check(readAll(logPath).empty() && log.lastLsn() == 3600, "checkpoint drops the log records it covers");
+
+        // Writers keep going while a background checkpoint runs
+        std::atomic<bool> done{false};
+        std::thread writer([&] {
+            RecordPatch patch;
+            patch.last = "Moved";
+            for (int i = 0; !done.load() || i < 2000; ++i) {
+                live.insertRecord({9603000 + i, "Busy", "B", "EE", 3.0, false});
+                live.deleteById(9600001 + (i % 2999));
+                live.updateById(9600002 + (i % 2998), patch);
+            }
+        });
+        bool ok = live.checkpoint(ckptPath);
+        done = true;
+        writer.join();
+        ts.check(ok && live.stats().deadVersions == 0, "checkpoint runs alongside writers and releases its view");
+
+        Engine recovered;
+        bool loaded = recovered.load(ckptPath) && recovered.replay(logPath);
+        int cmp = 0;
+        bool same = loaded && recovered.stats().liveRows == live.stats().liveRows &&
+                    recovered.prefixByLast("busy", cmp).size() == live.prefixByLast("busy", cmp).size() &&
+                    recovered.prefixByLast("moved", cmp).size() == live.prefixByLast("moved", cmp).size();
+        for (int id = 9600000; same && id < 9603000; ++id) {
+            const Record *x = live.findById(id, cmp), *y = recovered.findById(id, cmp);
+            same = (x == nullptr) == (y == nullptr) && (!x || x->last == y->last);
+        }
+        ts.check(same, "checkpoint + log tail rebuilds the engine");
+        Engine base;
+        uint64_t firstLsn = 0;
+        WriteAheadLog::replay(logPath, [&](uint64_t lsn, uint8_t, const char *, size_t) {
+            if (!firstLsn) firstLsn = lsn;
+        });
+        ts.check(base.load(ckptPath) &&
+                 (firstLsn ? firstLsn == base.logPosition + 1 : log.lastLsn() == base.logPosition),
+                 "log keeps only the records after the checkpoint");
+
+        // A record larger than one scan chunk, in a log reopened after the truncation
+        live.attachLog(nullptr);
+        log.close();
+        ts.check(log.open(logPath, recovered.logPosition), "truncated log reopens");
+        live.attachLog(&log);
+        std::string wide(200000, 'w');
+        live.insertRecord({9700000, "Wide", wide, "CS", 4.0, false});
+        Engine again;
+        const Record *w = again.load(ckptPath) && again.replay(logPath) ? again.findById(9700000, cmp) : nullptr;
+        ts.check(w && w->first == wide && again.stats().liveRows == live.stats().liveRows,
+                 "replay streams a record larger than its read chunk");
+        live.attachLog(nullptr);
+        log.close();
+        std::remove(logPath.c_str());
+        std::remove(ckptPath.c_str());
+        std::remove(savePath.c_str());
+    }
+
+    // --- Test: CSV/TSV bulk import (header, CRLF, bad lines, repeated IDs) ---
+    {
+        const std::string path = "test_import.csv";
+        {
+            std::FILE *f = std::fopen(path.c_str(), "wb");
+            std::fputs("id,last,first,major,gpa\n"
+                       "9700001,Smith,Ann,CS,3.5\n"
+                       "9700002,Nguyen,Bao,Math,3.9\r\n"
+                       "\n"
+                       "9700003,Lee,Chris,EE\n"               // too few fields
+                       "97x0004,Kim,Dana,Bio,3.0\n"           // bad ID
+                       "9700005,Park,Eli,Chem,3.1,extra\n"    // too many fields
+                       "9700006,Patel,Farah,Econ,abc\n"       // bad GPA
+                       "9700001,Dup,Gus,CS,1.0\n"             // repeated ID: first wins
+                       "9700007,Ali,Hana,Bio,2.75",           // no final newline
+                       f);
+            std::fclose(f);
+        }
+        Engine eng;
+        CsvImportStats st;
+        int cmp = 0;
+        ts.check(eng.importCsv(path, st), "importCsv reads the file");
+        ts.check(st.header && st.rows == 4 && st.rejected == 4 && st.inserted == 3, "import counts header, rows, rejects");
+        const Record *a = eng.findById(9700001, cmp), *b = eng.findById(9700002, cmp), *c = eng.findById(9700007, cmp);
+        ts.check(a && a->last == "Smith" && a->gpa == 3.5 && b && b->major == "Math" && b->gpa == 3.9 &&
+                 c && c->first == "Hana" && c->gpa == 2.75,
+                 "imported rows keep their columns (CRLF and last line included)");
+        ts.check(eng.prefixByLast("ng", cmp).size() == 1, "imported rows are indexed by last name");
+
+        // A malformed first data line is rejected, not mistaken for a header
+        const std::string bad = "12a,Smith,Ann,CS,3.5\r\n9700008,Ito,Ken,CS,3.0\n";
+        std::vector<Record> parsed;
+        CsvImportStats sb, sh;
+        CsvImporter::parse(bad.data(), bad.size(), parsed, sb);
+        const std::string crlfHeader = "ID,Last,First,Major,GPA\r\n9700008,Ito,Ken,CS,3.0\n";
+        CsvImporter::parse(crlfHeader.data(), crlfHeader.size(), parsed, sh);
+        ts.check(!sb.header && sb.rejected == 1 && sb.rows == 1 && sh.header && sh.rejected == 0 && sh.rows == 1,
+                 "only a line without numbers counts as a header");
+
+        // A TSV split across several threads gives the same rows as one thread
+        std::string tsv;
+        for (int i = 0; i < 60000; ++i)
+            tsv += std::to_string(9800000 + i) + "\tTsv" + std::to_string(i % 9) + "\tT\tCS\t" + std::to_string(i % 4) + ".25\n";
+        std::vector<Record> one, many;
+        CsvImportStats s1, s4;
+        CsvImporter::parse(tsv.data(), tsv.size(), one, s1, '\t', 1);
+        CsvImporter::parse(tsv.data(), tsv.size(), many, s4, '\t', 4);
+        bool same = one.size() == 60000 && many.size() == one.size() && !s1.header && s4.rejected == 0;
+        for (size_t i = 0; same && i < one.size(); ++i)
+            same = one[i].id == many[i].id && one[i].last == many[i].last && one[i].gpa == many[i].gpa;
+        ts.check(same, "multi-threaded parse matches single-threaded parse");
+        ts.check(!eng.importCsv("no_such_file.csv", st), "importCsv fails on a missing file");
+        std::remove(path.c_str());
+    }
+
+    // --- Test: streaming export to CSV and columnar files ---
+    {
+        const std::string csvPath = "test_export.csv", colPath = "test_export.col";
+        Engine eng;
+        for (int i = 0; i < 10000; ++i)
+            eng.insertRecord({9900000 + i, i % 3 ? "Export" : "Other", "E" + std::to_string(i), "CS", 2.0 + (i % 200) / 99.0, false});
+        int cmp = 0;
+
+        // CSV export of an ID range reads back as the same rows (GPA exactly)
+        CsvSink csv(csvPath, ',', true, 4096);   // small buffer: many flushes
+        size_t exported = eng.exportRangeById(9902000, 9907999, csv);
+        ts.check(csv.finish() && exported == 6000 && csv.count() == 6000, "exportRangeById streams the range");
+        std::vector<Record> back;
+        CsvImportStats st;
+        bool same = CsvImporter::readFile(csvPath, back, st) && st.header && back.size() == 6000;
+        std::vector<const Record *> expected = eng.rangeById(9902000, 9907999, cmp);
+        for (size_t i = 0; same && i < back.size(); ++i)
+            same = back[i].id == expected[i]->id && back[i].last == expected[i]->last &&
+                   back[i].first == expected[i]->first && back[i].gpa == expected[i]->gpa;
+        ts.check(same, "CSV export round-trips through CsvImporter");
+
+        CsvSink prefixCsv(csvPath, '\t', false);
+        ts.check(eng.exportPrefixByLast("oth", prefixCsv) == eng.prefixByLast("oth", cmp).size() && prefixCsv.finish(),
+                 "exportPrefixByLast matches prefixByLast");
+
+        // Batches release the latch before the sink runs: a sink that writes
+        // to the engine does not deadlock, and the export keeps its image
+        struct WritingSink {
+            Engine &eng;
+            std::vector<Record> rows;
+            bool add(const Record &rec) {
+                if (rows.empty()) {
+                    eng.deleteById(9900002);   // "Export", not yet exported
+                    eng.insertRecord({9910000, "Exporter", "Late", "CS", 3.0, false});
+                }
+                rows.push_back(rec);
+                return true;
+            }
+        };
+        std::vector<const Record *> before = eng.prefixByLast("exp", cmp);
+        WritingSink writing{eng, {}};
+        bool inOrder = eng.exportPrefixByLast("exp", writing) == before.size();
+        for (size_t i = 0; inOrder && i < before.size(); ++i)
+            inOrder = writing.rows[i].id == before[i]->id;
+        ts.check(inOrder && before.size() > Engine::kExportBatch && !eng.findById(9900002, cmp) &&
+                 eng.findById(9910000, cmp),
+                 "batched export sees one image while the sink writes to the engine");
+
+        // Every idIndex type stops and resumes a range walk at batch bounds
+        struct IdSink {
+            std::vector<int> ids;
+            bool add(const Record &rec) {
+                ids.push_back(rec.id);
+                return true;
+            }
+        };
+        auto batched = [&](auto &e, const std::string &name) {
+            const int n = 3 * (int)Engine::kExportBatch + 7;
+            for (int i = 0; i < n; ++i) e.insertRecord({9920000 + 2 * i, "Batch", "B", "CS", 2.0, false});
+            IdSink sink;
+            bool ok = e.exportRangeById(9920001, INT_MAX, sink) == size_t(n - 1) && (int)sink.ids.size() == n - 1;
+            for (int i = 1; ok && i < n; ++i) ok = sink.ids[i - 1] == 9920000 + 2 * i;
+            ts.check(ok, name + ": batched range export returns every row once, in order");
+        };
+        SplayEngine b2;
+        TreapEngine b3;
+        ConcurrentEngine b4;
+        SkipListEngine b5;
+        PersistentEngine b6;
+        batched(b2, "SplayEngine");
+        batched(b3, "TreapEngine");
+        batched(b4, "ConcurrentEngine");
+        batched(b5, "SkipListEngine");
+        batched(b6, "PersistentEngine");
+
+        // Columnar export: blocks of blockRows rows
+        ColumnarWriter col(colPath, 1000);
+        eng.exportRangeById(INT_MIN, INT_MAX, col);
+        ts.check(col.finish() && col.count() == 10000, "columnar export writes every row");
+        ColumnarReader reader;
+        ts.check(reader.open(colPath) && reader.blockInfo().size() == 10 && reader.rows() == 10000 &&
+                 reader.blockInfo()[0].minId == 9900000,
+                 "columnar file holds the rows in blocks");
+        std::remove(csvPath.c_str());
+        std::remove(colPath.c_str());
+    }
+
+    // --- Test: columnar archive with zone maps and dictionary pages ---
+    {
+        const std::string path = "test_archive.col";
+        Engine eng;
+        const char *majors[] = {"CS", "Math", "EE"};
+        for (int i = 0; i < 20000; ++i) {
+            // GPA rises with the ID, so gpa zone maps are selective too;
+            // "Bio" only appears in the last 500 rows
+            const char *major = i >= 19500 ? "Bio" : majors[i % 3];
+            eng.insertRecord({9950000 + i, "Arch" + std::to_string(i % 11), "F" + std::to_string(i), major,
+                              i / 5000.0, false});
+        }
+        eng.deleteById(9950007);
+        ts.check(eng.saveColumnar(path, 1000), "saveColumnar writes the archive");
+
+        // Everything: same rows as the engine, in ID order
+        std::vector<Record> all;
+        ColumnarPredicate everything;
+        ColumnarScanStats st = Engine::scanColumnar(path, everything, [&](const RecordView &v) { all.push_back(v.toRecord()); });
+        int cmp = 0;
+        bool same = st.ok && st.blocks == 20 && all.size() == 19999;
+        for (size_t i = 0; same && i < all.size(); ++i) {
+            const Record *r = eng.findById(all[i].id, cmp);
+            same = r && r->last == all[i].last && r->first == all[i].first && r->major == all[i].major &&
+                   r->gpa == all[i].gpa && (i == 0 || all[i - 1].id < all[i].id);
+        }
+        ts.check(same, "columnar scan returns every archived row");
+
+        // gpa >= 3.9 touches only the last block; an id range only its blocks
+        ColumnarPredicate honors;
+        honors.minGpa = 3.9;
+        size_t expected = 0;
+        for (const Record &r : all) expected += r.gpa >= 3.9;
+        size_t found = 0;
+        st = Engine::scanColumnar(path, honors, [&](const RecordView &v) { found += v.gpa >= 3.9; });
+        ts.check(st.ok && st.rows == expected && found == expected && st.skippedByZoneMap == 19,
+                 "gpa predicate skips blocks by zone map");
+        ColumnarPredicate range;
+        range.minId = 9952500;
+        range.maxId = 9953499;
+        st = Engine::scanColumnar(path, range, [](const RecordView &) {});
+        ts.check(st.rows == 1000 && st.skippedByZoneMap == 18, "id range skips blocks by zone map");
+
+        // major = "Bio" is only in the last block's dictionary
+        ColumnarPredicate bio;
+        bio.major = "Bio";
+        bool allBio = true;
+        st = Engine::scanColumnar(path, bio, [&](const RecordView &v) { allBio = allBio && v.major == "Bio"; });
+        ts.check(st.rows == 500 && allBio && st.skippedByDictionary == 19, "major predicate skips blocks by dictionary");
+
+        // A truncated file is rejected
+        {
+            std::FILE *in = std::fopen(path.c_str(), "rb");
+            std::vector<char> bytes(1 << 20);
+            bytes.resize(std::fread(bytes.data(), 1, bytes.size(), in));
+            std::fclose(in);
+
+            // (the major dictionary page opens each block, ahead of the columns)
+            ColumnarReader reader;
+            uint32_t page[4] = {};
+            if (reader.open(path)) std::memcpy(page, bytes.data() + reader.blockInfo()[0].offset, sizeof(page));
+            ts.check(page[0] == 3 && page[1] == 2 && page[2] == 4 && page[3] == 2,
+                     "major dictionary page starts the block");
+            std::FILE *out = std::fopen(path.c_str(), "wb");
+            std::fwrite(bytes.data(), 1, bytes.size() - 9, out);
+            std::fclose(out);
+        }
+        ts.check(!Engine::scanColumnar(path, everything, [](const RecordView &) {}).ok, "truncated archive is rejected");
+        std::remove(path.c_str());
+    }
+
     return ts.summarize();
 }